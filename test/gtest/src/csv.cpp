@@ -0,0 +1,100 @@
+#include "trie/trie.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+static std::string write_csv( const std::string& name, const std::string& content)
+{
+	std::string filename = testing::TempDir() + name;
+	FILE* file = fopen( filename.c_str(), "wb");
+	fwrite( content.data(), 1, content.size(), file);
+	fclose( file );
+	return filename;
+}
+
+static std::vector< std::pair<std::string, std::string> > read_all( const std::string& filename, size_t block_size, trie::CsvStats& stats)
+{
+	std::vector< std::pair<std::string, std::string> > toReturn;
+
+	trie::CsvReader reader( filename, block_size);
+	trie::CsvField word, translation;
+	while (reader.next( word, translation))
+		toReturn.push_back( std::make_pair( std::string( word.data, word.length ), std::string( translation.data, translation.length ) ) );
+
+	stats = reader.get_stats();
+	return toReturn;
+}
+
+TEST(CsvTests, Format)
+{
+	std::string filename = write_csv( "format.csv",
+		"cat,gata\r\n"
+		"\n"
+		"no separator\n"
+		"dog,skylos,with comma\n"
+		"\"a,b\",\"say \"\"hi\"\"\"\r\n"
+		"\"multi\nline\",x\n"
+		"\"bad\"quote,y\n"
+		"last,no new line");
+
+	std::vector< std::pair<std::string, std::string> > expected = {
+		{ "cat", "gata" },
+		{ "dog", "skylos,with comma" },
+		{ "a,b", "say \"hi\"" },
+		{ "multi\nline", "x" },
+		{ "last", "no new line" } };
+
+	// records crossing the blocks of the reader, and blocks smaller than a record
+	for (size_t block_size : { 2, 3, 7, 64, 1 << 20 })
+	{
+		trie::CsvStats stats;
+		EXPECT_EQ( expected , read_all( filename, block_size, stats) );
+		EXPECT_EQ( 5u , stats.records );
+		EXPECT_EQ( 2u , stats.malformed );
+		EXPECT_EQ( 3u , stats.first_malformed_line );
+	}
+
+	trie::CsvStats stats;
+	read_all( write_csv( "unterminated.csv", "a,b\n\"never closed,c\nd,e\n"), 4, stats);
+	EXPECT_EQ( 1u , stats.records );
+	EXPECT_EQ( 1u , stats.malformed );
+	EXPECT_EQ( 2u , stats.first_malformed_line );
+
+	EXPECT_THROW( trie::CsvReader( testing::TempDir() + "missing.csv" ), trie::ErrorOpeningCsvException );
+}
+
+TEST(CsvTests, Import)
+{
+	std::string filename = write_csv( "import.csv", "cat,gata\ndog,skylos\ncat,again\nbroken\n\"a,b\",c\n");
+
+	trie::Trie<uint8_t> t;
+	trie::CsvStats stats = t.insert_from_csv( filename );
+	EXPECT_EQ( 4u , stats.records );
+	EXPECT_EQ( 3u , stats.accepted );
+	EXPECT_EQ( 1u , stats.rejected );
+	EXPECT_EQ( 1u , stats.malformed );
+	EXPECT_EQ( std::vector<uint8_t>( { 'g', 'a', 't', 'a', 0 } ) , t.search_word( (const uint8_t*) "cat" ) );
+	EXPECT_EQ( std::vector<uint8_t>( { 'c', 0 } ) , t.search_word( (const uint8_t*) "a,b" ) );
+
+	// one character per byte for wider characters
+	trie::Trie<uint32_t> u;
+	EXPECT_EQ( 3u , u.insert_from_csv( filename ).accepted );
+	EXPECT_EQ( std::vector<uint32_t>( { 's', 'k', 'y', 'l', 'o', 's', 0 } ) , u.search_word( std::vector<uint32_t>( { 'd', 'o', 'g', 0 } ) ) );
+
+	// UTF-8 is decoded for wider characters
+	std::string utf8 = write_csv( "utf8.csv", "\xce\xb3\xce\xac\xcf\x84\xce\xb1,cat\nbad\xff,x\n");
+	trie::Trie<uint16_t> v;
+	stats = v.insert_from_csv( utf8 );
+	EXPECT_EQ( 1u , stats.accepted );
+	EXPECT_EQ( 1u , stats.invalid_encoding );
+	EXPECT_EQ( 4u , v.get_range_words( NULL, NULL, 1 )[0].size() - 1 );
+	EXPECT_EQ( 2u , t.insert_from_csv( utf8 ).accepted );
+
+	stats = t.delete_from_csv( write_csv( "delete.csv", "cat,\nmouse,\n") );
+	EXPECT_EQ( 1u , stats.accepted );
+	EXPECT_EQ( 1u , stats.rejected );
+	EXPECT_EQ( 4u , t.get_entry_count() );
+}
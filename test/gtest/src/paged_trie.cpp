@@ -0,0 +1,115 @@
+#include "trie/paged_trie.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+static std::vector<uint8_t> to_word( const std::string& s)
+{
+	std::vector<uint8_t> toReturn( s.begin(), s.end() );
+	toReturn.push_back( 0 );
+	return toReturn;
+}
+
+TEST(PagedTrieTests, SmallBufferPool)
+{
+	std::string dictionary = testing::TempDir() + "paged_trie_tests.dict";
+	std::remove( dictionary.c_str() );
+
+	// many more pages than the 4 pages of the buffer pool
+	std::map<std::string, std::string> expected;
+	{
+		trie::PagedTrie<uint8_t> t( dictionary, 4 * 512, 512 );
+		for (int i = 0; i < 3000; i++)
+		{
+			std::string word = "w" + std::to_string( (i * 7919) % 3000 );
+			std::string translation = "t" + std::to_string( i );
+			EXPECT_TRUE( t.add_word( to_word(word), to_word(translation) ) );
+			expected[word] = translation;
+		}
+		EXPECT_FALSE( t.add_word( to_word("w1"), to_word("x") ) );
+		EXPECT_TRUE( t.add_word( to_word(""), to_word("empty") ) );
+		expected[""] = "empty";
+
+		for (int i = 0; i < 3000; i += 3)
+		{
+			EXPECT_TRUE( t.delete_word( to_word( "w" + std::to_string(i) ) ) );
+			expected.erase( "w" + std::to_string(i) );
+		}
+		EXPECT_FALSE( t.delete_word( to_word("w0") ) );
+		EXPECT_FALSE( t.delete_word( to_word("w") ) );
+
+		trie::PagedTrieStats stats = t.get_stats();
+		EXPECT_EQ( expected.size() , stats.entry_count );
+		EXPECT_EQ( 4u , stats.cached_pages );
+		EXPECT_GT( stats.page_count , 4u );
+		EXPECT_GT( stats.pool.evictions , 0u );
+		EXPECT_GT( stats.pool.writes , 0u );
+		EXPECT_GT( stats.garbage_bytes , 0u );
+
+		// space of deleted nodes is reused
+		uint64_t page_count = stats.page_count;
+		EXPECT_TRUE( t.add_word( to_word("w0"), to_word("again") ) );
+		expected["w0"] = "again";
+		EXPECT_EQ( page_count , t.get_stats().page_count );
+	}
+	{
+		// reopened with a bigger pool, page_size comes from the file
+		trie::PagedTrie<uint8_t> t( dictionary, 1 << 20 );
+		EXPECT_EQ( expected.size() , t.get_entry_count() );
+		for (auto& pair : expected)
+			EXPECT_EQ( to_word(pair.second) , t.search_word( to_word(pair.first) ) );
+		EXPECT_TRUE( t.search_word( to_word("w3") ).empty() );
+		EXPECT_TRUE( t.search_word( to_word("x") ).empty() );
+
+		// words of a prefix, in lexicographic order
+		std::vector< std::vector<uint8_t> > words = t.get_prefix_words( to_word("w29"), -1 );
+		std::vector< std::vector<uint8_t> > expected_words;
+		for (auto& pair : expected)
+			if (pair.first.compare( 0, 3, "w29" ) == 0)
+				expected_words.push_back( to_word(pair.first) );
+		EXPECT_EQ( expected_words , words );
+		EXPECT_EQ( 2u , t.get_prefix_words( to_word("w29"), 2 ).size() );
+		EXPECT_EQ( expected.size() , t.get_prefix_words( to_word(""), -1 ).size() );
+	}
+	{
+		// other files and character sizes are refused
+		EXPECT_THROW( trie::PagedTrie<uint16_t> t( dictionary, 1 << 20 ), trie::ErrorReadingDictionaryException );
+
+		// and so are pages smaller than 512 bytes, page_size follows the mark of the header
+		uint32_t page_size = 0;
+		FILE* file = fopen( dictionary.c_str(), "r+b");
+		fseek( file, sizeof(uint64_t), SEEK_SET);
+		fwrite( &page_size, sizeof(uint32_t), 1, file);
+		fclose( file );
+		EXPECT_THROW( trie::PagedTrie<uint8_t> t( dictionary, 1 << 20 ), trie::ErrorReadingDictionaryException );
+	}
+	std::remove( dictionary.c_str() );
+}
+
+TEST(PagedTrieTests, FailedWrites)
+{
+	// every write of /dev/full fails
+	FILE* file = fopen( "/dev/full", "r+b");
+	if (file == NULL)
+		return;
+
+	{
+		trie::BufferPool pool( "/dev/full", file, 512, 2, 0 );
+		uint64_t page = pool.allocate( 1 );
+		pool.write( page * 512, "x", 1 );
+		EXPECT_THROW( pool.flush(), trie::ErrorWritingDictionaryException );
+
+		// the page is still changed, and it is written again by the next flush
+		EXPECT_THROW( pool.flush(), trie::ErrorWritingDictionaryException );
+		EXPECT_EQ( 0u , pool.get_stats().writes );
+
+		char c = 0;
+		pool.read( page * 512, &c, 1 );
+		EXPECT_EQ( 'x' , c );
+	}
+	fclose( file );
+}
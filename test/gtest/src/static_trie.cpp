@@ -0,0 +1,70 @@
+#include "trie/static_trie.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace
+{
+
+enum class Token { get, head, post, put, patch, options };
+
+constexpr trie::StaticEntry<char, Token> verbs[] =
+{
+	{ "GET", Token::get },
+	{ "HEAD", Token::head },
+	{ "POST", Token::post },
+	{ "PUT", Token::put },
+	{ "PATCH", Token::patch },
+	{ "OPTIONS", Token::options },
+	{ "GET", Token::post }
+};
+
+constexpr trie::StaticTrie<char, Token, trie::static_trie_nodes(verbs)> table( verbs );
+
+// the whole table is built and searched by the compiler
+static_assert( table.get_entry_count() == 6, "duplicate words are added once" );
+static_assert( table.get_node_count() == 25, "one TrieNode per distinct prefix" );
+static_assert( *table.search_word( "PATCH" ) == Token::patch, "" );
+static_assert( *table.search_word( "GET" ) == Token::get, "the first value of a word is kept" );
+static_assert( table.search_word( "PA" ) == NULL, "prefixes are not words" );
+static_assert( table.search_word( "" ) == NULL, "" );
+
+}
+
+TEST(StaticTrieTests, Lookups)
+{
+	// same lookups at run time, with words that the compiler doesn't know
+	std::string words[] = { "GET", "HEAD", "POST", "PUT", "PATCH", "OPTIONS" };
+	Token tokens[] = { Token::get, Token::head, Token::post, Token::put, Token::patch, Token::options };
+	for (int i = 0; i < 6; i++)
+	{
+		const Token* token = table.search_word( words[i] );
+		ASSERT_NE( (const Token*) NULL , token );
+		EXPECT_EQ( tokens[i] , *token );
+	}
+
+	std::string missing[] = { "", "G", "GETS", "get", "POS", "OPTION", "X" };
+	for (const std::string& word : missing)
+		EXPECT_EQ( (const Token*) NULL , table.search_word( word ) );
+
+	uint32_t matched_length = 0;
+	EXPECT_EQ( Token::put , *table.longest_prefix_match( "PUT /index.html", matched_length ) );
+	EXPECT_EQ( 3u , matched_length );
+	EXPECT_EQ( (const Token*) NULL , table.longest_prefix_match( "DELETE /", matched_length ) );
+	EXPECT_EQ( 0u , matched_length );
+
+	// tables of other character types, with the empty word
+	constexpr trie::StaticEntry<char16_t, int> wide[] = { { u"", 0 }, { u"α", 1 }, { u"αβ", 2 } };
+	constexpr trie::StaticTrie<char16_t, int, trie::static_trie_nodes(wide)> wide_table( wide );
+	static_assert( *wide_table.search_word( u"αβ" ) == 2, "" );
+	EXPECT_EQ( 0 , *wide_table.search_word( u"" ) );
+	EXPECT_EQ( 1 , *wide_table.longest_prefix_match( u"αγ", matched_length ) );
+	EXPECT_EQ( 1u , matched_length );
+
+	// the table can be built at run time too, a node count that is too small throws
+	trie::StaticEntry<char, int> entries[] = { { "ab", 1 }, { "ac", 2 } };
+	EXPECT_THROW( (trie::StaticTrie<char, int, 3>( entries )), trie::StaticTrieSizeException );
+	trie::StaticTrie<char, int, 4> runtime_table( entries );
+	EXPECT_EQ( 2 , *runtime_table.search_word( "ac" ) );
+}
@@ -37,4 +37,15 @@ TEST(StringTests, Strcmp)
 	v1 = {1,2,3,0};
 	v2 = {1,2,3,0};
 	EXPECT_EQ( 0 , trie::strcmp( v1, v2 ) );
-}
\ No newline at end of file
+}
+TEST(StringTests, LongStrings)
+{
+	// lengths bigger than the maximum value of the character type
+	std::vector<uint8_t> v( 1000, 1 );
+	v.push_back( 0 );
+	EXPECT_EQ( 1000u , trie::strlen( v ) );
+
+	std::vector<uint8_t> copy( v.size() );
+	trie::strcpy( copy.data(), v.data() );
+	EXPECT_EQ( 0 , trie::strcmp( v, copy ) );
+}
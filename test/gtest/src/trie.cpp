@@ -0,0 +1,1275 @@
+#include "trie/trie.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+/* words of a Trie<uint8_t> as strings, without their end_of_string */
+static std::vector<std::string> to_strings( const std::vector< std::vector<uint8_t> >& words)
+{
+	std::vector<std::string> toReturn;
+	for (const std::vector<uint8_t>& w : words)
+		toReturn.push_back( std::string( w.begin(), w.end() - 1 ) );
+	return toReturn;
+}
+
+/* Tries that keep the number of words of every sub-trie, for count_prefix, rank and select */
+template <class character_t, class value_t = std::vector<character_t>, class alphabet_t = trie::FullAlphabet<character_t> >
+using CountedTrie = trie::Trie<character_t, value_t, alphabet_t, trie::NodeOptions<true> >;
+
+/* Tries that keep the scores of their words, for set_score, get_score and top_k_completions */
+template <class character_t, class value_t = std::vector<character_t>, class alphabet_t = trie::FullAlphabet<character_t> >
+using ScoredTrie = trie::Trie<character_t, value_t, alphabet_t, trie::NodeOptions<false, true> >;
+
+TEST(TrieTests, StringTranslations)
+{
+	trie::Trie<uint8_t> t;
+
+	std::vector<uint8_t> w1 = {'a','b',0};
+	std::vector<uint8_t> t1 = {'x',0};
+	std::vector<uint8_t> w2 = {'a',0};
+	std::vector<uint8_t> t2 = {'y','z',0};
+
+	EXPECT_TRUE( t.add_word( w1, t1 ) );
+	EXPECT_TRUE( t.add_word( w2, t2 ) );
+	EXPECT_FALSE( t.add_word( w1, t2 ) );
+	EXPECT_EQ( 2 , t.get_entry_count() );
+
+	EXPECT_EQ( t1 , t.search_word( w1 ) );
+	EXPECT_EQ( t2 , t.search_word( w2 ) );
+
+	EXPECT_TRUE( t.delete_word( w2 ) );
+	EXPECT_TRUE( t.search_word( w2 ).empty() );
+	EXPECT_EQ( t1 , t.search_word( w1 ) );
+}
+
+TEST(TrieTests, ValueTranslations)
+{
+	struct Item
+	{
+		uint64_t id;
+		uint16_t flags;
+
+		bool operator==( const Item& other) const
+		{
+			return (id == other.id) && (flags == other.flags);
+		}
+	};
+
+	trie::Trie<uint8_t, Item> t;
+
+	std::vector<uint8_t> w1 = {'a','b',0};
+	std::vector<uint8_t> w2 = {'a','c',0};
+
+	EXPECT_TRUE( t.add_word( w1, Item{ 1ull << 40, 3 } ) );
+	EXPECT_TRUE( t.add_word( w2, Item{ 7, 0 } ) );
+
+	ASSERT_NE( nullptr , t.search_word( w1 ) );
+	EXPECT_EQ( 1ull << 40 , t.search_word( w1 )->id );
+	EXPECT_EQ( 3 , t.search_word( w1 )->flags );
+	EXPECT_EQ( 7u , t.search_word( w2 )->id );
+
+	// equal values with different padding bytes are not changed words
+	Item a, b;
+	memset( &a, 0x00, sizeof(Item));
+	memset( &b, 0xFF, sizeof(Item));
+	a.id = b.id = 7;
+	a.flags = b.flags = 0;
+	trie::Trie<uint8_t, Item> other;
+	other.add_word( w1, Item{ 1ull << 40, 3 } );
+	other.add_word( w2, b );
+	t.delete_word( w2 );
+	t.add_word( w2, a );
+	EXPECT_TRUE( t.diff( other ).changed.empty() );
+
+	EXPECT_TRUE( t.delete_word( w1 ) );
+	EXPECT_EQ( nullptr , t.search_word( w1 ) );
+}
+
+TEST(TrieTests, ValueSaveLoad)
+{
+	std::string dictionary = testing::TempDir() + "trie_tests_values.dict";
+	std::remove( dictionary.c_str() );
+
+	std::vector<uint16_t> w1 = {300,2,0};
+	std::vector<uint16_t> w2 = {300,0};
+	{
+		trie::Trie<uint16_t, uint64_t> t( dictionary );
+		t.add_word( w1, 123456789012ull );
+		t.add_word( w2, 42ull );
+		t.save_changes();
+	}
+	{
+		trie::Trie<uint16_t, uint64_t> t( dictionary );
+		EXPECT_EQ( 2 , t.get_entry_count() );
+		ASSERT_NE( nullptr , t.search_word( w1 ) );
+		EXPECT_EQ( 123456789012ull , *t.search_word( w1 ) );
+		EXPECT_EQ( 42ull , *t.search_word( w2 ) );
+	}
+
+	// a dictionary of 8-byte values can not be read as 4-byte values
+	EXPECT_THROW( (trie::Trie<uint16_t, uint32_t>( dictionary )), trie::ErrorReadingDictionaryException );
+
+	std::remove( dictionary.c_str() );
+}
+
+TEST(TrieTests, LongestPrefixMatch)
+{
+	trie::Trie<uint8_t> t;
+
+	std::vector<uint8_t> w1 = {'1','0',0};
+	std::vector<uint8_t> w2 = {'1','0','.','2',0};
+	std::vector<uint8_t> t1 = {'a',0};
+	std::vector<uint8_t> t2 = {'b',0};
+	t.add_word( w1, t1 );
+	t.add_word( w2, t2 );
+
+	uint32_t matched_length;
+	std::vector<uint8_t> key = {'1','0','.','2','.','7',0};
+	EXPECT_EQ( t2 , t.longest_prefix_match( key, matched_length ) );
+	EXPECT_EQ( 4u , matched_length );
+
+	key = {'1','0','.','3',0};
+	EXPECT_EQ( t1 , t.longest_prefix_match( key, matched_length ) );
+	EXPECT_EQ( 2u , matched_length );
+
+	key = {'1',0};
+	EXPECT_TRUE( t.longest_prefix_match( key, matched_length ).empty() );
+	EXPECT_EQ( 0u , matched_length );
+
+	key = {'1','0','.','2','.','7',0};
+	std::vector< std::vector<uint8_t> > expected = { w1, w2 };
+	EXPECT_EQ( expected , t.get_matching_prefixes( key ) );
+	EXPECT_EQ( expected , t.get_matching_prefixes( key.data(), 4 ) );
+
+	// only the first key_length characters of the key are read
+	expected = { w1 };
+	EXPECT_EQ( expected , t.get_matching_prefixes( key.data(), 3 ) );
+	EXPECT_TRUE( t.get_matching_prefixes( key.data(), 1 ).empty() );
+}
+
+TEST(TrieTests, CountRankSelect)
+{
+	CountedTrie<uint8_t> t;
+
+	std::vector< std::vector<uint8_t> > words = { {'b',0}, {'a','b',0}, {'a',0}, {'a','b','c',0}, {'c','a',0}, {'a','c',0} };
+	std::vector<uint8_t> translation = {'x',0};
+	for (auto& w : words)
+		t.add_word( w, translation );
+
+	std::vector<uint8_t> prefix = {'a',0};
+	EXPECT_EQ( 4u , t.count_prefix( prefix ) );
+	prefix = {'a','b',0};
+	EXPECT_EQ( 2u , t.count_prefix( prefix ) );
+	prefix = {'d',0};
+	EXPECT_EQ( 0u , t.count_prefix( prefix ) );
+	prefix = {0};
+	EXPECT_EQ( 6u , t.count_prefix( prefix ) );
+
+	// sorted: a, ab, abc, ac, b, ca
+	std::vector< std::vector<uint8_t> > sorted = { {'a',0}, {'a','b',0}, {'a','b','c',0}, {'a','c',0}, {'b',0}, {'c','a',0} };
+	for (uint64_t k = 0; k < sorted.size(); k++)
+	{
+		EXPECT_EQ( sorted[k] , t.select( k ) );
+		EXPECT_EQ( k , t.rank( sorted[k] ) );
+	}
+	EXPECT_TRUE( t.select( 6 ).empty() );
+
+	// words that are not saved
+	std::vector<uint8_t> w = {'a','b','b',0};
+	EXPECT_EQ( 2u , t.rank( w ) );
+	w = {'z',0};
+	EXPECT_EQ( 6u , t.rank( w ) );
+
+	// only the first word_length characters of the word are read
+	EXPECT_EQ( 1u , t.rank( sorted[2].data(), 2 ) );
+	EXPECT_EQ( 0u , t.rank( sorted[2].data(), 1 ) );
+	EXPECT_EQ( 0u , t.rank( sorted[2].data(), 0 ) );
+
+	t.delete_word( sorted[1] );
+	prefix = {'a',0};
+	EXPECT_EQ( 3u , t.count_prefix( prefix ) );
+	EXPECT_EQ( sorted[2] , t.select( 1 ) );
+}
+
+TEST(TrieTests, NodeOptions)
+{
+	// counts and scores are kept only by the Tries that ask for them, other TrieNodes keep the same size for all characters
+	using counted_node = trie::TrieNode<uint8_t, std::vector<uint8_t>, trie::FullAlphabet<uint8_t>, trie::NodeOptions<true> >;
+	using scored_node = trie::TrieNode<uint8_t, std::vector<uint8_t>, trie::FullAlphabet<uint8_t>, trie::NodeOptions<false, true> >;
+	EXPECT_EQ( sizeof(trie::TrieNode<uint8_t>) , sizeof(trie::TrieNode<uint16_t>) );
+	EXPECT_EQ( sizeof(trie::TrieNode<uint8_t>) , sizeof(trie::TrieNode<uint32_t>) );
+	EXPECT_EQ( sizeof(trie::TrieNode<uint8_t>) + sizeof(uint64_t) , sizeof(counted_node) );
+	EXPECT_EQ( sizeof(trie::TrieNode<uint8_t>) + 2 * sizeof(uint32_t) , sizeof(scored_node) );
+
+	// without counts, words of sub-tries are counted by visiting them, emptied sub-tries of lazy pruning count no words
+	trie::Trie<uint8_t, uint32_t> t, other;
+	CountedTrie<uint8_t, uint32_t> counted;
+	t.set_lazy_pruning( true );
+	counted.set_lazy_pruning( true );
+	const char* words[] = { "app", "apple", "apply", "band", "banana", "cat" };
+	for (uint32_t i = 0; i < 6; i++)
+	{
+		EXPECT_TRUE( t.add_word( (const uint8_t*) words[i], i ) );
+		EXPECT_TRUE( counted.add_word( (const uint8_t*) words[i], i ) );
+	}
+	EXPECT_TRUE( t.delete_word( (const uint8_t*) "cat" ) );
+	EXPECT_TRUE( counted.delete_word( (const uint8_t*) "cat" ) );
+
+	EXPECT_EQ( 0u , t.delete_prefix( (const uint8_t*) "c" ) );
+	EXPECT_EQ( counted.delete_prefix( (const uint8_t*) "ap" ) , t.delete_prefix( (const uint8_t*) "ap" ) );
+	EXPECT_EQ( 2u , t.get_entry_count() );
+
+	other.set_lazy_pruning( true );
+	for (const char* w : { "band", "cow", "dog" })
+		EXPECT_TRUE( other.add_word( (const uint8_t*) w, 9 ) );
+	EXPECT_TRUE( other.delete_word( (const uint8_t*) "cow" ) );
+	EXPECT_EQ( 1u , t.merge_from( other ) );
+	EXPECT_EQ( (std::vector<std::string>{ "banana", "band", "dog" }) , to_strings( t.get_range_words( NULL, NULL, -1 ) ) );
+
+	for (const char* w : { "band", "dog", "cow" })
+		EXPECT_TRUE( other.add_word( (const uint8_t*) w, 9 ) );
+	EXPECT_EQ( 1u , t.intersect( other ) );
+	EXPECT_EQ( 2u , t.get_entry_count() );
+
+	// compact leaves the emptied sub-tries out
+	t.compact();
+	EXPECT_EQ( 8u , t.get_stats().node_count );
+	EXPECT_EQ( (std::vector<std::string>{ "band", "dog" }) , to_strings( t.get_range_words( NULL, NULL, -1 ) ) );
+}
+
+TEST(TrieTests, RangeWords)
+{
+	trie::Trie<uint8_t> t;
+
+	std::vector< std::vector<uint8_t> > sorted = { {'a',0}, {'a','b',0}, {'a','b','c',0}, {'a','c',0}, {'b',0}, {'c','a',0} };
+	std::vector<uint8_t> translation = {'x',0};
+	for (auto it = sorted.rbegin(); it != sorted.rend(); ++it)
+		t.add_word( *it, translation );
+
+	// [ab, b)
+	std::vector<uint8_t> lo = {'a','b',0};
+	std::vector<uint8_t> hi = {'b',0};
+	std::vector< std::vector<uint8_t> > expected = { sorted[1], sorted[2], sorted[3] };
+	EXPECT_EQ( expected , t.get_range_words( lo, hi, -1 ) );
+
+	// bounds that are not saved words
+	lo = {'a','a',0};
+	hi = {'a','c','a',0};
+	expected = { sorted[1], sorted[2], sorted[3] };
+	EXPECT_EQ( expected , t.get_range_words( lo, hi, -1 ) );
+
+	// limit
+	expected = { sorted[1], sorted[2] };
+	EXPECT_EQ( expected , t.get_range_words( lo, hi, 2 ) );
+
+	// open ranges
+	EXPECT_EQ( sorted , t.get_range_words( NULL, NULL, -1 ) );
+	hi = {'a','b',0};
+	expected = { sorted[0] };
+	EXPECT_EQ( expected , t.get_range_words( NULL, hi.data(), -1 ) );
+	lo = {'b',0};
+	expected = { sorted[4], sorted[5] };
+	EXPECT_EQ( expected , t.get_range_words( lo.data(), NULL, -1 ) );
+
+	// translations are given to the callback
+	uint64_t visited = t.for_each_in_range( NULL, NULL, 3, [&]( const uint8_t*, const uint8_t* tr)
+	{
+		EXPECT_EQ( 0 , trie::strcmp( tr, translation.data() ) );
+	});
+	EXPECT_EQ( 3u , visited );
+}
+
+TEST(TrieTests, RestrictedAlphabet)
+{
+	// a few code points, mapped to letters 0..4 of uint8_t
+	using alphabet = trie::ListAlphabet<uint32_t, 'a', 'b', 0x3B1, 0x3B2, 0x1F600>;
+	static_assert( std::is_same< alphabet::letter_type, uint8_t >::value, "5 letters fit in uint8_t" );
+	static_assert( alphabet::lower_bound( 0x3B2 ) == 3, "letters follow the order of the characters" );
+	static_assert( alphabet::lower_bound( 'c' ) == 2, "missing characters get the position of the next letter" );
+
+	CountedTrie<uint32_t, std::vector<uint32_t>, alphabet> t;
+
+	std::vector<uint32_t> w1 = {0x3B1,'a',0};
+	std::vector<uint32_t> w2 = {'b',0x1F600,0};
+	std::vector<uint32_t> w3 = {'b',0};
+	std::vector<uint32_t> w4 = {'c',0};
+	std::vector<uint32_t> translation = {'x',0};
+
+	EXPECT_TRUE( t.add_word( w1, translation ) );
+	EXPECT_TRUE( t.add_word( w2, translation ) );
+	EXPECT_TRUE( t.add_word( w3, translation ) );
+	EXPECT_FALSE( t.add_word( w4, translation ) );
+	EXPECT_EQ( 3u , t.get_entry_count() );
+
+	EXPECT_EQ( translation , t.search_word( w2 ) );
+	EXPECT_TRUE( t.search_word( w4 ).empty() );
+
+	std::vector< std::vector<uint32_t> > sorted = { w3, w2, w1 };
+	EXPECT_EQ( sorted , t.get_range_words( NULL, NULL, -1 ) );
+	EXPECT_EQ( w1 , t.select( 2 ) );
+	EXPECT_EQ( 2u , t.rank( w4 ) );
+
+	// bounds with characters outside of the alphabet
+	std::vector<uint32_t> lo = {'b','c',0};
+	std::vector< std::vector<uint32_t> > expected = { w2 };
+	EXPECT_EQ( expected , t.get_range_words( lo, w1, -1 ) );
+
+	// a range alphabet over 'a'..'z'
+	trie::Trie<uint8_t, uint32_t, trie::RangeAlphabet<uint8_t, 'a', 'z'> > r;
+	std::vector<uint8_t> w5 = {'z','a',0};
+	std::vector<uint8_t> w6 = {'z','A',0};
+	EXPECT_TRUE( r.add_word( w5, 5u ) );
+	EXPECT_FALSE( r.add_word( w6, 6u ) );
+	EXPECT_EQ( 5u , *r.search_word( w5 ) );
+}
+
+TEST(TrieTests, LengthAwareWords)
+{
+	CountedTrie<uint8_t> t;
+
+	// words with the end_of_string value inside them
+	uint8_t w1[] = {'a',0,'b'};
+	uint8_t w2[] = {'a',0};
+	std::vector<uint8_t> translation = {'x',0};
+
+	EXPECT_TRUE( t.add_word( w1, 3, translation.data() ) );
+	EXPECT_TRUE( t.add_word( w2, 1, translation.data() ) );
+	EXPECT_FALSE( t.add_word( w1, 3, translation.data() ) );
+
+	EXPECT_EQ( translation , t.search_word( w1, 3 ) );
+	EXPECT_TRUE( t.search_word( w1, 2 ).empty() );
+	EXPECT_EQ( 2u , t.count_prefix( w1, 1 ) );
+
+	uint32_t matched_length;
+	EXPECT_EQ( translation , t.longest_prefix_match( w1, 3, matched_length ) );
+	EXPECT_EQ( 3u , matched_length );
+
+	EXPECT_TRUE( t.delete_word( w1, 3 ) );
+	EXPECT_FALSE( t.delete_word( w1, 3 ) );
+	EXPECT_EQ( 1u , t.get_entry_count() );
+
+	// words longer than the maximum word size
+	std::vector<uint8_t> long_word( 300, 'a' );
+	EXPECT_FALSE( t.add_word( long_word.data(), long_word.size(), translation.data() ) );
+	EXPECT_TRUE( t.search_word( long_word.data(), long_word.size() ).empty() );
+}
+
+TEST(TrieTests, DeletePruning)
+{
+	// random words over a small alphabet, checked against a std::map
+	for (int lazy = 0; lazy < 2; lazy++)
+	{
+		trie::Trie<uint8_t> t;
+		t.set_lazy_pruning( lazy == 1 );
+		std::map< std::vector<uint8_t>, bool > reference;
+		std::mt19937 generator( 7 );
+
+		for (int i = 0; i < 4000; i++)
+		{
+			std::vector<uint8_t> w( 1 + generator() % 4 );
+			for (auto& c : w)
+				c = 1 + generator() % 6;
+			w.push_back( 0 );
+
+			if (generator() % 3 == 0)
+				EXPECT_EQ( reference.erase( w ) == 1 , t.delete_word( w ) );
+			else
+				EXPECT_EQ( reference.insert( std::make_pair( w, true ) ).second , t.add_word( w, w ) );
+
+			if (i % 1000 == 999)
+				t.compact();
+		}
+
+		EXPECT_EQ( reference.size() , t.get_entry_count() );
+
+		std::vector< std::vector<uint8_t> > expected;
+		for (auto& i : reference)
+			expected.push_back( i.first );
+		EXPECT_EQ( expected , t.get_range_words( NULL, NULL, -1 ) );
+
+		for (auto& i : reference)
+			EXPECT_TRUE( t.delete_word( i.first ) );
+		EXPECT_TRUE( t.is_empty() );
+		t.compact();
+		EXPECT_TRUE( t.get_range_words( NULL, NULL, -1 ).empty() );
+	}
+}
+
+TEST(TrieTests, FullNode)
+{
+	// every letter of the alphabet under the same TrieNode, no zeros groups left
+	trie::Trie<uint8_t, uint32_t> t;
+	for (uint32_t i = 0; i < 256; i++)
+	{
+		uint8_t w[2] = { (uint8_t) i, (uint8_t) i };
+		EXPECT_TRUE( t.add_word( w, 2, i ) );
+	}
+
+	for (uint32_t i = 0; i < 256; i += 3)
+	{
+		uint8_t w[2] = { (uint8_t) i, (uint8_t) i };
+		EXPECT_TRUE( t.delete_word( w, 2 ) );
+	}
+
+	for (uint32_t i = 0; i < 256; i++)
+	{
+		uint8_t w[2] = { (uint8_t) i, (uint8_t) i };
+		const uint32_t* found = t.search_word( w, 2 );
+		if (i % 3 == 0)
+			EXPECT_TRUE( found == NULL );
+		else
+			EXPECT_TRUE( (found != NULL) && (*found == i) );
+	}
+}
+
+TEST(TrieTests, DeletePrefix)
+{
+	CountedTrie<uint8_t, uint32_t> t;
+	const char* words[] = { "app", "apple", "applet", "apply", "ape", "banana", "band" };
+	for (uint32_t i = 0; i < 7; i++)
+		EXPECT_TRUE( t.add_word( (const uint8_t*) words[i], i ) );
+
+	EXPECT_EQ( 0u , t.delete_prefix( (const uint8_t*) "apx" ) );
+	EXPECT_EQ( 4u , t.delete_prefix( (const uint8_t*) "app" ) );
+	EXPECT_EQ( 3u , t.get_entry_count() );
+	EXPECT_EQ( 1u , t.count_prefix( (const uint8_t*) "ap" ) );
+	EXPECT_TRUE( t.search_word( (const uint8_t*) "apple" ) == NULL );
+	EXPECT_TRUE( t.search_word( (const uint8_t*) "ape" ) != NULL );
+
+	// the last word under "ap" takes its emptied parents along
+	EXPECT_EQ( 1u , t.delete_prefix( (const uint8_t*) "ape" ) );
+	EXPECT_EQ( 0u , t.count_prefix( (const uint8_t*) "a" ) );
+	EXPECT_TRUE( t.add_word( (const uint8_t*) "apple", 10 ) );
+
+	// empty prefix deletes everything
+	EXPECT_EQ( 3u , t.delete_prefix( (const uint8_t*) "" ) );
+	EXPECT_TRUE( t.is_empty() );
+	EXPECT_TRUE( t.add_word( (const uint8_t*) "band", 11 ) );
+	EXPECT_EQ( 11u , *t.search_word( (const uint8_t*) "band" ) );
+}
+
+TEST(TrieTests, AddBatch)
+{
+	std::vector< std::vector<uint8_t> > words;
+	std::vector<uint32_t> values;
+	const char* batch[] = { "banana", "apple", "app", "applet", "banana", "band", "" };
+	for (uint32_t i = 0; i < 7; i++)
+	{
+		words.push_back( std::vector<uint8_t>( batch[i], batch[i] + strlen(batch[i]) + 1 ) );
+		values.push_back( i );
+	}
+
+	CountedTrie<uint8_t, uint32_t> t;
+	EXPECT_TRUE( t.add_word( (const uint8_t*) "band", 100 ) );
+
+	// second "banana" and the already saved "band" fail, the rest are added
+	std::vector<bool> expected = { true, true, true, true, false, false, true };
+	EXPECT_EQ( expected , t.add_batch( words, values ) );
+	EXPECT_EQ( 6u , t.get_entry_count() );
+	EXPECT_EQ( 0u , *t.search_word( (const uint8_t*) "banana" ) );
+	EXPECT_EQ( 100u , *t.search_word( (const uint8_t*) "band" ) );
+	EXPECT_EQ( 6u , *t.search_word( (const uint8_t*) "" ) );
+	EXPECT_EQ( 3u , t.count_prefix( (const uint8_t*) "app" ) );
+
+	// sorted batch, same result as single insertions
+	trie::Trie<uint8_t> s, u;
+	std::vector< std::vector<uint8_t> > sorted_words = { {'a',0}, {'a','b',0}, {'a','b','c',0}, {'b',0} };
+	EXPECT_EQ( std::vector<bool>( 4, true) , s.add_batch( sorted_words, sorted_words ) );
+	for (auto& w : sorted_words)
+		EXPECT_TRUE( u.add_word( w, w ) );
+	EXPECT_EQ( u.get_range_words( NULL, NULL, -1 ) , s.get_range_words( NULL, NULL, -1 ) );
+	EXPECT_EQ( sorted_words[2] , s.search_word( sorted_words[2] ) );
+}
+
+TEST(TrieTests, MergeDiffIntersect)
+{
+	CountedTrie<uint8_t, uint32_t> a, b;
+	const char* a_words[] = { "app", "apple", "band", "cat" };
+	const char* b_words[] = { "apple", "apply", "band", "dog", "dot" };
+	for (uint32_t i = 0; i < 4; i++)
+		EXPECT_TRUE( a.add_word( (const uint8_t*) a_words[i], i ) );
+	for (uint32_t i = 0; i < 5; i++)
+		EXPECT_TRUE( b.add_word( (const uint8_t*) b_words[i], 10 + i ) );
+
+	trie::TrieDiff<uint8_t> d = a.diff( b );
+	EXPECT_EQ( (std::vector<std::string>{ "apply", "dog", "dot" }) , to_strings( d.added ) );
+	EXPECT_EQ( (std::vector<std::string>{ "app", "cat" }) , to_strings( d.removed ) );
+	EXPECT_EQ( (std::vector<std::string>{ "apple", "band" }) , to_strings( d.changed ) );
+	EXPECT_TRUE( a.diff( a ).added.empty() && a.diff( a ).removed.empty() && a.diff( a ).changed.empty() );
+
+	// intersection keeps the translations of a
+	CountedTrie<uint8_t, uint32_t> c;
+	for (uint32_t i = 0; i < 4; i++)
+		EXPECT_TRUE( c.add_word( (const uint8_t*) a_words[i], i ) );
+	EXPECT_EQ( 2u , c.intersect( b ) );
+	EXPECT_EQ( (std::vector<std::string>{ "apple", "band" }) , to_strings( c.get_range_words( NULL, NULL, -1 ) ) );
+	EXPECT_EQ( 1u , *c.search_word( (const uint8_t*) "apple" ) );
+	EXPECT_EQ( 2u , c.count_prefix( (const uint8_t*) "" ) );
+
+	// merge moves everything out of b
+	EXPECT_EQ( 3u , a.merge_from( b, trie::ConflictPolicy::overwrite ) );
+	EXPECT_TRUE( b.is_empty() );
+	EXPECT_TRUE( b.get_range_words( NULL, NULL, -1 ).empty() );
+	EXPECT_EQ( 7u , a.get_entry_count() );
+	EXPECT_EQ( (std::vector<std::string>{ "app", "apple", "apply", "band", "cat", "dog", "dot" }) , to_strings( a.get_range_words( NULL, NULL, -1 ) ) );
+	EXPECT_EQ( 10u , *a.search_word( (const uint8_t*) "apple" ) );
+	EXPECT_EQ( 14u , *a.search_word( (const uint8_t*) "dot" ) );
+	EXPECT_EQ( 2u , a.count_prefix( (const uint8_t*) "do" ) );
+	EXPECT_EQ( std::vector<uint8_t>( { 'd', 'o', 'g', 0 } ) , a.select( 5 ) );
+
+	// b is still usable
+	EXPECT_TRUE( b.add_word( (const uint8_t*) "cow", 20 ) );
+	EXPECT_EQ( 1u , a.merge_from( b ) );
+	EXPECT_EQ( 8u , a.get_entry_count() );
+
+	CountedTrie<uint8_t, uint32_t> e( '$' );
+	EXPECT_THROW( a.merge_from( e ), trie::ConflictingTriesException );
+}
+
+TEST(TrieTests, CompactLayout)
+{
+	trie::Trie<uint8_t, uint32_t> t, other;
+	std::map< std::vector<uint8_t>, uint32_t > reference;
+	std::mt19937 generator( 11 );
+	for (uint32_t i = 0; i < 2000; i++)
+	{
+		std::vector<uint8_t> w( 1 + generator() % 5 );
+		for (auto& c : w)
+			c = 'a' + generator() % 8;
+		if (t.add_word( w.data(), w.size(), i ))
+			reference[w] = i;
+	}
+
+	trie::TrieStats before = t.get_stats();
+	EXPECT_EQ( 0u , before.arena_bytes );
+	EXPECT_EQ( 0u , before.translation_bytes );
+
+	t.compact();
+	trie::TrieStats after = t.get_stats();
+	EXPECT_EQ( before.node_count , after.node_count );
+	EXPECT_EQ( reference.size() , after.entry_count );
+	EXPECT_GE( after.arena_bytes , after.node_bytes );
+
+	// the compacted Trie keeps changing as usual
+	for (auto i = reference.begin(); i != reference.end(); )
+	{
+		if (generator() % 2)
+		{
+			EXPECT_TRUE( t.delete_word( i->first.data(), i->first.size() ) );
+			i = reference.erase( i );
+		}
+		else
+		{
+			i++;
+		}
+	}
+	std::vector<uint8_t> w = { 'z', 'z' };
+	EXPECT_TRUE( t.add_word( w.data(), w.size(), 7 ) );
+	reference[w] = 7;
+
+	// nodes of a compacted Trie moved in another Trie
+	other.compact();
+	other.merge_from( t );
+	t.compact();
+	EXPECT_EQ( reference.size() , other.get_entry_count() );
+	for (auto& i : reference)
+		EXPECT_EQ( i.second , *other.search_word( i.first.data(), i.first.size() ) );
+
+	trie::Trie<uint8_t> s;
+	s.add_word( (const uint8_t*) "a", (const uint8_t*) "abc" );
+	EXPECT_EQ( 4u , s.get_stats().translation_bytes );
+}
+
+TEST(TrieTests, TopKCompletions)
+{
+	std::string dictionary = testing::TempDir() + "trie_tests_scores.dict";
+	std::remove( dictionary.c_str() );
+
+	std::vector<uint8_t> car = {'c','a','r',0};
+	std::vector<uint8_t> cart = {'c','a','r','t',0};
+	std::vector<uint8_t> cat = {'c','a','t',0};
+	std::vector<uint8_t> cab = {'c','a','b',0};
+	std::vector<uint8_t> dog = {'d','o','g',0};
+	std::vector<uint8_t> ca = {'c','a',0};
+	std::vector<uint8_t> x = {'x',0};
+	{
+		ScoredTrie<uint8_t> t( dictionary );
+		EXPECT_TRUE( t.add_word( car.data(), 3, x.data(), 50 ) );
+		EXPECT_TRUE( t.add_word( cart.data(), 4, x.data(), 80 ) );
+		EXPECT_TRUE( t.add_word( cat.data(), 3, x.data(), 20 ) );
+		EXPECT_TRUE( t.add_word( cab, x ) );
+		EXPECT_TRUE( t.add_word( dog.data(), 3, x.data(), 90 ) );
+
+		auto best = t.top_k_completions( ca, 2 );
+		ASSERT_EQ( 2u , best.size() );
+		EXPECT_EQ( cart , best[0].first );
+		EXPECT_EQ( 80u , best[0].second );
+		EXPECT_EQ( car , best[1].first );
+
+		// words without a score come last
+		EXPECT_EQ( cab , t.top_k_completions( ca, 10 ).back().first );
+		EXPECT_EQ( 4u , t.top_k_completions( ca, 10 ).size() );
+		EXPECT_EQ( dog , t.top_k_completions( std::vector<uint8_t>{0}, 1 )[0].first );
+
+		// max. scores follow deletions and score changes
+		EXPECT_TRUE( t.delete_word( cart ) );
+		EXPECT_TRUE( t.set_score( cat, 60 ) );
+		EXPECT_FALSE( t.set_score( cart, 1 ) );
+		EXPECT_EQ( cat , t.top_k_completions( ca, 1 )[0].first );
+		EXPECT_EQ( 0u , t.get_score( cart ) );
+		EXPECT_EQ( 0u , t.delete_prefix( std::vector<uint8_t>{'e',0} ) );
+		EXPECT_EQ( 1u , t.delete_prefix( std::vector<uint8_t>{'d',0} ) );
+		EXPECT_EQ( cat , t.top_k_completions( std::vector<uint8_t>{0}, 1 )[0].first );
+		t.save_changes();
+	}
+	{
+		ScoredTrie<uint8_t> t( dictionary );
+		EXPECT_EQ( 3u , t.get_entry_count() );
+		EXPECT_EQ( 60u , t.get_score( cat ) );
+		EXPECT_EQ( 50u , t.get_score( car ) );
+		EXPECT_EQ( cat , t.top_k_completions( ca, 1 )[0].first );
+
+		// without scores, the file keeps the simple header
+		t.set_score( cat, 0 );
+		t.set_score( car, 0 );
+		t.save_changes();
+	}
+	{
+		FILE* file = fopen( dictionary.c_str(), "rb" );
+		EXPECT_EQ( 1 , fgetc( file ) );
+		fclose( file );
+
+		ScoredTrie<uint8_t> t( dictionary );
+		EXPECT_EQ( 3u , t.get_entry_count() );
+		EXPECT_EQ( 0u , t.get_score( cat ) );
+	}
+	std::remove( dictionary.c_str() );
+
+	// best-first search against sorting every completion
+	ScoredTrie<uint8_t, uint32_t> r;
+	std::vector< std::pair<uint32_t, std::vector<uint8_t>> > reference;
+	std::mt19937 generator( 5 );
+	for (uint32_t i = 0; i < 3000; i++)
+	{
+		std::vector<uint8_t> w( 1 + generator() % 6 );
+		for (auto& c : w)
+			c = 'a' + generator() % 4;
+		uint32_t score = generator() % 1000;
+		if (r.add_word( w.data(), w.size(), i, score ) && w[0] == 'b')
+		{
+			w.push_back( 0 );
+			reference.push_back( std::make_pair( score, w ) );
+		}
+	}
+	std::sort( reference.begin(), reference.end(), []( const std::pair<uint32_t, std::vector<uint8_t>>& a, const std::pair<uint32_t, std::vector<uint8_t>>& b)
+	{
+		return (a.first != b.first) ? (a.first > b.first) : (a.second < b.second);
+	});
+
+	auto best = r.top_k_completions( std::vector<uint8_t>{'b',0}, 25 );
+	ASSERT_EQ( 25u , best.size() );
+	for (uint32_t i = 0; i < 25; i++)
+	{
+		EXPECT_EQ( reference[i].second , best[i].first );
+		EXPECT_EQ( reference[i].first , best[i].second );
+	}
+}
+
+TEST(TrieTests, FuzzySearch)
+{
+	trie::Trie<uint8_t> t;
+	std::vector<uint8_t> x = {'x',0};
+	for (const char* w : { "cat", "cart", "care", "bat", "act", "dog", "cats", "ca" })
+		t.add_word( (const uint8_t*) w, x.data() );
+
+	auto matches = t.fuzzy_search( (const uint8_t*) "cat", 1, -1 );
+	std::vector< std::pair< std::vector<uint8_t>, uint32_t > > expected = {
+		{ {'b','a','t',0}, 1 }, { {'c','a',0}, 1 }, { {'c','a','r','t',0}, 1 }, { {'c','a','t',0}, 0 }, { {'c','a','t','s',0}, 1 } };
+	EXPECT_EQ( expected , matches );
+
+	EXPECT_EQ( 2u , t.fuzzy_search( (const uint8_t*) "cat", 1, 2 ).size() );
+	EXPECT_EQ( 1u , t.fuzzy_search( (const uint8_t*) "cat", 0, -1 ).size() );
+	EXPECT_EQ( 8u , t.fuzzy_search( (const uint8_t*) "", 4, -1 ).size() );
+
+	// queries far longer than any saved word need no table, and any number of edits keeps every word
+	std::vector<uint8_t> long_query( 20000000, 'c' );
+	EXPECT_TRUE( t.fuzzy_search( long_query.data(), (uint32_t) long_query.size(), 2, -1 ).empty() );
+	EXPECT_EQ( 8u , t.fuzzy_search( (const uint8_t*) "cat", std::numeric_limits<uint32_t>::max(), -1 ).size() );
+
+	// against the edit distance of every saved word
+	auto distance = []( const std::vector<uint8_t>& a, const std::vector<uint8_t>& b)
+	{
+		std::vector< std::vector<uint32_t> > d( a.size() + 1, std::vector<uint32_t>( b.size() + 1 ) );
+		for (uint32_t i = 0; i <= a.size(); i++)
+			for (uint32_t j = 0; j <= b.size(); j++)
+				d[i][j] = (i == 0) ? j : (j == 0) ? i :
+						  std::min( { d[i-1][j] + 1, d[i][j-1] + 1, d[i-1][j-1] + (a[i-1] != b[j-1]) } );
+		return d[a.size()][b.size()];
+	};
+
+	trie::Trie<uint8_t, uint32_t> r;
+	std::vector< std::vector<uint8_t> > words;
+	std::mt19937 generator( 3 );
+	for (uint32_t i = 0; i < 3000; i++)
+	{
+		std::vector<uint8_t> w( 1 + generator() % 7 );
+		for (auto& c : w)
+			c = 'a' + generator() % 5;
+		if (r.add_word( w.data(), w.size(), i ))
+			words.push_back( w );
+	}
+	std::sort( words.begin(), words.end() );
+
+	for (uint32_t q = 0; q < 20; q++)
+	{
+		std::vector<uint8_t> query( generator() % 8 );
+		for (auto& c : query)
+			c = 'a' + generator() % 5;
+		uint32_t max_edits = q % 3;
+
+		std::vector< std::pair< std::vector<uint8_t>, uint32_t > > reference;
+		for (auto& w : words)
+		{
+			uint32_t d = distance( query, w );
+			if (d <= max_edits)
+			{
+				reference.push_back( std::make_pair( w, d ) );
+				reference.back().first.push_back( 0 );
+			}
+		}
+		EXPECT_EQ( reference , r.fuzzy_search( query.data(), query.size(), max_edits, -1 ) );
+	}
+}
+
+TEST(TrieTests, PatternWords)
+{
+	trie::Trie<uint8_t> t;
+	std::vector<uint8_t> x = {'x',0};
+	for (const char* w : { "code", "coke", "come", "cone", "core", "cove", "coder", "cod", "co*e", "cafe", "dome" })
+		t.add_word( (const uint8_t*) w, x.data() );
+
+	EXPECT_EQ( (std::vector<std::string>{ "co*e", "code", "coke", "come", "cone", "core", "cove" }) , to_strings( t.get_pattern_words( (const uint8_t*) "co?e", -1 ) ) );
+	EXPECT_EQ( (std::vector<std::string>{ "cafe", "co*e", "code", "coke", "come", "cone", "core", "cove" }) , to_strings( t.get_pattern_words( (const uint8_t*) "c*e", -1 ) ) );
+	EXPECT_EQ( (std::vector<std::string>{ "cod", "code", "coder" }) , to_strings( t.get_pattern_words( (const uint8_t*) "cod*", -1 ) ) );
+	EXPECT_EQ( (std::vector<std::string>{ "come", "cone", "dome" }) , to_strings( t.get_pattern_words( (const uint8_t*) "[cd]o[m-n]e", -1 ) ) );
+	EXPECT_EQ( (std::vector<std::string>{ "co*e", "code", "coke", "cove" }) , to_strings( t.get_pattern_words( (const uint8_t*) "co[!m-r]e", -1 ) ) );
+	EXPECT_EQ( (std::vector<std::string>{ "co*e" }) , to_strings( t.get_pattern_words( (const uint8_t*) "co\\*e", -1 ) ) );
+	EXPECT_EQ( 2u , t.get_pattern_words( (const uint8_t*) "**o**e*", 2 ).size() );
+	EXPECT_EQ( 11u , t.get_pattern_words( (const uint8_t*) "*", -1 ).size() );
+	EXPECT_TRUE( t.get_pattern_words( (const uint8_t*) "co", -1 ).empty() );
+
+	uint64_t visited = t.for_each_match( (const uint8_t*) "co?e", -1, [&]( const uint8_t* word, const uint8_t* translation)
+	{
+		EXPECT_EQ( 4u , trie::strlen( word, (uint8_t) 0 ) );
+		EXPECT_EQ( 'x' , translation[0] );
+	});
+	EXPECT_EQ( 7u , visited );
+
+	EXPECT_THROW( t.get_pattern_words( (const uint8_t*) "co[de", -1 ), trie::InvalidPatternException );
+	EXPECT_THROW( t.get_pattern_words( (const uint8_t*) "co\\", -1 ), trie::InvalidPatternException );
+}
+
+TEST(TrieTests, ReverseIndex)
+{
+	std::string dictionary = testing::TempDir() + "trie_tests_reverse.dict";
+	std::remove( dictionary.c_str() );
+
+	std::vector<uint8_t> other_translation( 250, 'y' );
+	other_translation.push_back( 0 );
+	{
+		trie::Trie<uint8_t> t( dictionary );
+		t.add_word( (const uint8_t*) "chat", (const uint8_t*) "cat" );
+		t.add_word( (const uint8_t*) "gato", (const uint8_t*) "cat" );
+
+		// without the index, every pair is visited
+		EXPECT_EQ( (std::vector<std::string>{ "chat", "gato" }) , to_strings( t.search_translation( (const uint8_t*) "cat" ) ) );
+
+		t.enable_reverse_index();
+		EXPECT_TRUE( t.has_reverse_index() );
+		EXPECT_GT( t.get_stats().reverse_index_bytes , 0u );
+		t.add_word( (const uint8_t*) "katze", (const uint8_t*) "cat" );
+		t.add_word( (const uint8_t*) "hund", (const uint8_t*) "dog" );
+		t.add_word( (const uint8_t*) "chien", (const uint8_t*) "dog" );
+		EXPECT_EQ( (std::vector<std::string>{ "chat", "gato", "katze" }) , to_strings( t.search_translation( (const uint8_t*) "cat" ) ) );
+		EXPECT_TRUE( t.search_translation( (const uint8_t*) "ca" ).empty() );
+
+		EXPECT_TRUE( t.delete_word( (const uint8_t*) "gato" ) );
+		EXPECT_EQ( 2u , t.delete_prefix( (const uint8_t*) "ch" ) );
+		EXPECT_EQ( (std::vector<std::string>{ "katze" }) , to_strings( t.search_translation( (const uint8_t*) "cat" ) ) );
+		EXPECT_EQ( (std::vector<std::string>{ "hund" }) , to_strings( t.search_translation( (const uint8_t*) "dog" ) ) );
+
+		// the index takes translations of any length, same as the Trie without it
+		std::vector<uint8_t> long_translation( 1000, 'x' );
+		long_translation.push_back( 0 );
+		EXPECT_TRUE( t.add_word( (const uint8_t*) "long", long_translation.data() ) );
+		EXPECT_EQ( (std::vector<std::string>{ "long" }) , to_strings( t.search_translation( long_translation ) ) );
+		EXPECT_TRUE( t.delete_word( (const uint8_t*) "long" ) );
+		EXPECT_TRUE( t.search_translation( long_translation ).empty() );
+
+		trie::Trie<uint8_t> other;
+		other.add_word( (const uint8_t*) "kot", (const uint8_t*) "cat" );
+		other.add_word( (const uint8_t*) "hund", (const uint8_t*) "hound" );
+		other.add_word( (const uint8_t*) "lang", other_translation.data() );
+		EXPECT_EQ( 2u , t.merge_from( other, trie::ConflictPolicy::overwrite ) );
+		EXPECT_TRUE( t.has_reverse_index() );
+		EXPECT_EQ( (std::vector<std::string>{ "katze", "kot" }) , to_strings( t.search_translation( (const uint8_t*) "cat" ) ) );
+		EXPECT_EQ( (std::vector<std::string>{ "lang" }) , to_strings( t.search_translation( other_translation ) ) );
+		EXPECT_TRUE( t.search_translation( (const uint8_t*) "dog" ).empty() );
+
+		t.compact();
+		t.save_changes();
+	}
+	{
+		// the index is read from the file, a lazy Trie finds the words of pending segments in it
+		trie::Trie<uint8_t> lazy( dictionary, trie::LoadMode::lazy );
+		EXPECT_TRUE( lazy.has_reverse_index() );
+		EXPECT_EQ( 4u , lazy.get_pending_count() );
+		EXPECT_EQ( (std::vector<std::string>{ "katze", "kot" }) , to_strings( lazy.search_translation( (const uint8_t*) "cat" ) ) );
+		EXPECT_EQ( 4u , lazy.get_pending_count() );
+		EXPECT_TRUE( lazy.add_word( (const uint8_t*) "mao", (const uint8_t*) "cat" ) );
+		EXPECT_TRUE( lazy.delete_word( (const uint8_t*) "kot" ) );
+		EXPECT_EQ( (std::vector<std::string>{ "katze", "mao" }) , to_strings( lazy.search_translation( (const uint8_t*) "cat" ) ) );
+
+		trie::Trie<uint8_t> t( dictionary );
+		EXPECT_TRUE( t.has_reverse_index() );
+		EXPECT_EQ( (std::vector<std::string>{ "katze", "kot" }) , to_strings( t.search_translation( (const uint8_t*) "cat" ) ) );
+		EXPECT_EQ( (std::vector<std::string>{ "hund" }) , to_strings( t.search_translation( (const uint8_t*) "hound" ) ) );
+		EXPECT_EQ( (std::vector<std::string>{ "lang" }) , to_strings( t.search_translation( other_translation ) ) );
+
+		EXPECT_EQ( 4u , t.delete_prefix( (const uint8_t*) "" ) );
+		EXPECT_TRUE( t.search_translation( (const uint8_t*) "cat" ).empty() );
+
+		t.disable_reverse_index();
+		EXPECT_EQ( 0u , t.get_stats().reverse_index_bytes );
+	}
+	{
+		// an index with more translations than the file keeps is a broken file, nothing is allocated for it
+		std::fstream file( dictionary, std::ios::in | std::ios::out | std::ios::binary );
+		uint64_t index_position, segments_count, translation_count = (uint64_t) 1 << 40;
+		file.seekg( -2 * (long) sizeof(uint64_t), std::ios::end );
+		file.read( (char*) &index_position, sizeof(uint64_t) );
+		file.seekg( (long) index_position, std::ios::beg );
+		file.read( (char*) &segments_count, sizeof(uint64_t) );
+		file.seekp( (long) (index_position + 2 * sizeof(uint64_t) + segments_count * (1 + 2 * sizeof(uint64_t))), std::ios::beg );
+		file.write( (const char*) &translation_count, sizeof(uint64_t) );
+		file.close();
+
+		EXPECT_THROW( trie::Trie<uint8_t> t( dictionary ), trie::ErrorReadingDictionaryException );
+		EXPECT_THROW( trie::Trie<uint8_t> t( dictionary, trie::LoadMode::lazy ), trie::ErrorReadingDictionaryException );
+	}
+	std::remove( dictionary.c_str() );
+}
+
+TEST(TrieTests, SuffixWords)
+{
+	std::string dictionary = testing::TempDir() + "trie_tests_suffix.dict";
+	std::remove( dictionary.c_str() );
+
+	std::vector<uint8_t> x = {'x',0};
+	{
+		trie::Trie<uint8_t> t( dictionary );
+		for (const char* w : { "going", "sing", "bring", "ring", "rang", "in" })
+			t.add_word( (const uint8_t*) w, x.data() );
+
+		// same results with and without the index
+		for (int indexed = 0; indexed < 2; indexed++)
+		{
+			EXPECT_EQ( (std::vector<std::string>{ "going", "ring", "bring", "sing" }) , to_strings( t.get_suffix_words( (const uint8_t*) "ing", -1 ) ) );
+			EXPECT_EQ( (std::vector<std::string>{ "going", "ring" }) , to_strings( t.get_suffix_words( (const uint8_t*) "ing", 2 ) ) );
+			EXPECT_EQ( (std::vector<std::string>{ "in" }) , to_strings( t.get_suffix_words( (const uint8_t*) "in", -1 ) ) );
+			EXPECT_TRUE( t.get_suffix_words( (const uint8_t*) "ong", -1 ).empty() );
+			EXPECT_EQ( 6u , t.get_suffix_words( (const uint8_t*) "", -1 ).size() );
+
+			t.enable_suffix_index();
+		}
+		EXPECT_GT( t.get_stats().suffix_index_bytes , 0u );
+
+		EXPECT_TRUE( t.delete_word( (const uint8_t*) "sing" ) );
+		EXPECT_EQ( 2u , t.delete_prefix( (const uint8_t*) "r" ) );
+		t.add_word( (const uint8_t*) "thing", x.data() );
+		EXPECT_EQ( (std::vector<std::string>{ "thing", "going", "bring" }) , to_strings( t.get_suffix_words( (const uint8_t*) "ing", -1 ) ) );
+
+		t.compact();
+		t.save_changes();
+	}
+	{
+		trie::Trie<uint8_t> t( dictionary );
+		EXPECT_TRUE( t.has_suffix_index() );
+		EXPECT_EQ( (std::vector<std::string>{ "thing", "going", "bring" }) , to_strings( t.get_suffix_words( (const uint8_t*) "ing", -1 ) ) );
+
+		trie::Trie<uint8_t> other;
+		other.add_word( (const uint8_t*) "wing", x.data() );
+		t.merge_from( other );
+		EXPECT_EQ( 4u , t.get_suffix_words( (const uint8_t*) "ing", -1 ).size() );
+
+		// the other Trie is empty after the merge
+		EXPECT_EQ( 5u , t.intersect( other ) );
+		EXPECT_TRUE( t.get_suffix_words( (const uint8_t*) "ing", -1 ).empty() );
+	}
+	std::remove( dictionary.c_str() );
+}
+
+TEST(TrieTests, Snapshots)
+{
+	std::vector<uint8_t> x = {'x',0};
+	std::vector<uint8_t> y = {'y',0};
+
+	ScoredTrie<uint8_t> t;
+	for (const char* w : { "cat", "car", "cart", "dog" })
+		t.add_word( (const uint8_t*) w, x.data() );
+	t.set_score( (const uint8_t*) "car", 5 );
+	t.enable_reverse_index();
+
+	// changes of the Trie are not seen by the snapshot
+	ScoredTrie<uint8_t> v1 = t.snapshot();
+	EXPECT_TRUE( t.add_word( (const uint8_t*) "cab", y.data() ) );
+	EXPECT_TRUE( t.delete_word( (const uint8_t*) "cart" ) );
+	EXPECT_TRUE( t.set_score( (const uint8_t*) "cat", 9 ) );
+	EXPECT_EQ( 1u , t.delete_prefix( (const uint8_t*) "d" ) );
+
+	EXPECT_EQ( 4u , v1.get_entry_count() );
+	EXPECT_EQ( 4u , v1.get_prefix_words( (const uint8_t*) "", -1 ).size() );
+	EXPECT_TRUE( v1.search_word( (const uint8_t*) "cab" ).empty() );
+	EXPECT_FALSE( v1.search_word( (const uint8_t*) "cart" ).empty() );
+	EXPECT_EQ( 0u , v1.get_score( (const uint8_t*) "cat" ) );
+	EXPECT_EQ( 5u , v1.top_k_completions( (const uint8_t*) "", 1 )[0].second );
+	EXPECT_EQ( 4u , v1.search_translation( x.data() ).size() );
+	EXPECT_TRUE( v1.search_translation( y.data() ).empty() );
+
+	EXPECT_EQ( 3u , t.get_entry_count() );
+	EXPECT_EQ( 9u , t.top_k_completions( (const uint8_t*) "", 1 )[0].second );
+	EXPECT_EQ( 1u , t.search_translation( y.data() ).size() );
+
+	// the two versions only differ in the changed paths
+	trie::TrieDiff<uint8_t> d = v1.diff( t );
+	EXPECT_EQ( 1u , d.added.size() );
+	EXPECT_EQ( 2u , d.removed.size() );
+	EXPECT_TRUE( d.changed.empty() );
+
+	// changes of the snapshot are not seen by the Trie, and compact keeps the shared translations
+	ScoredTrie<uint8_t> v2( t );
+	v2.compact();
+	EXPECT_TRUE( v2.delete_word( (const uint8_t*) "cab" ) );
+	v2.set_lazy_pruning( true );
+	EXPECT_TRUE( v2.delete_word( (const uint8_t*) "car" ) );
+	EXPECT_FALSE( t.search_word( (const uint8_t*) "cab" ).empty() );
+	EXPECT_EQ( y , t.search_word( (const uint8_t*) "cab" ) );
+	EXPECT_EQ( 1u , v2.get_entry_count() );
+	t.compact();
+	EXPECT_EQ( x , t.search_word( (const uint8_t*) "car" ) );
+
+	// merge and intersect with a version of the same Trie
+	EXPECT_EQ( 3u , v2.merge_from( v1 ) );
+	EXPECT_EQ( 4u , v2.get_entry_count() );
+	EXPECT_TRUE( v1.is_empty() );
+	ScoredTrie<uint8_t> same = t.snapshot();
+	EXPECT_EQ( 0u , t.intersect( same ) );
+	EXPECT_EQ( 1u , t.intersect( v2 ) );
+	EXPECT_EQ( 2u , t.get_entry_count() );
+
+	// rollback
+	ScoredTrie<uint8_t> v3 = t.snapshot();
+	t.delete_prefix( (const uint8_t*) "" );
+	EXPECT_TRUE( t.is_empty() );
+	t = v3;
+	EXPECT_EQ( 2u , t.get_entry_count() );
+	EXPECT_EQ( x , t.search_word( (const uint8_t*) "cat" ) );
+	EXPECT_EQ( 2u , t.search_translation( x.data() ).size() );
+}
+
+TEST(TrieTests, LazyLoading)
+{
+	std::string dictionary = testing::TempDir() + "trie_tests_lazy.dict";
+	std::remove( dictionary.c_str() );
+
+	std::vector<uint8_t> x = {'x',0};
+	{
+		ScoredTrie<uint8_t> t( dictionary );
+		for (const char* w : { "", "apple", "apply", "banana", "band", "cherry" })
+			t.add_word( (const uint8_t*) w, x.data() );
+		t.set_score( (const uint8_t*) "band", 4 );
+		t.save_changes();
+	}
+	{
+		// only the empty word is added when the file is opened
+		trie::Trie<uint8_t, std::vector<uint8_t>, trie::FullAlphabet<uint8_t>, trie::NodeOptions<true, true> > t( dictionary, trie::LoadMode::lazy );
+		EXPECT_EQ( 6u , t.get_entry_count() );
+		EXPECT_EQ( 5u , t.get_pending_count() );
+		EXPECT_EQ( x , t.search_word( (const uint8_t*) "" ) );
+		EXPECT_EQ( 5u , t.get_pending_count() );
+
+		// lookups add the segment of their first character
+		EXPECT_EQ( x , t.search_word( (const uint8_t*) "band" ) );
+		EXPECT_EQ( 4u , t.get_score( (const uint8_t*) "band" ) );
+		EXPECT_EQ( 3u , t.get_pending_count() );
+		EXPECT_TRUE( t.search_word( (const uint8_t*) "zebra" ).empty() );
+		EXPECT_FALSE( t.add_word( (const uint8_t*) "apple", x.data() ) );
+		EXPECT_EQ( 1u , t.get_pending_count() );
+		EXPECT_EQ( 2u , t.count_prefix( (const uint8_t*) "appl" ) );
+		EXPECT_EQ( 1u , t.get_pending_count() );
+
+		// functions over all words add all segments
+		EXPECT_EQ( 6u , t.get_prefix_words( (const uint8_t*) "", -1 ).size() );
+		EXPECT_EQ( 0u , t.get_pending_count() );
+		EXPECT_EQ( 6u , t.get_entry_count() );
+
+		t.delete_word( (const uint8_t*) "cherry" );
+		t.save_changes();
+	}
+	{
+		trie::Trie<uint8_t> t( dictionary, trie::LoadMode::lazy );
+		EXPECT_EQ( 5u , t.get_entry_count() );
+
+		// copies keep the pending segments, every Trie adds its own
+		trie::Trie<uint8_t> copy( t );
+		EXPECT_EQ( 4u , t.get_pending_count() );
+		EXPECT_EQ( 4u , copy.get_pending_count() );
+		EXPECT_EQ( x , copy.search_word( (const uint8_t*) "band" ) );
+		EXPECT_EQ( 2u , copy.get_pending_count() );
+		EXPECT_EQ( 5u , copy.get_prefix_words( (const uint8_t*) "", -1 ).size() );
+		EXPECT_EQ( 0u , copy.get_pending_count() );
+		EXPECT_EQ( 4u , t.get_pending_count() );
+
+		trie::Trie<uint8_t> assigned;
+		assigned = t;
+		EXPECT_EQ( 4u , assigned.get_pending_count() );
+		EXPECT_EQ( 5u , assigned.get_entry_count() );
+		EXPECT_EQ( x , assigned.search_word( (const uint8_t*) "apply" ) );
+		EXPECT_EQ( 4u , t.get_pending_count() );
+
+		trie::Trie<uint8_t> eager( dictionary );
+		EXPECT_TRUE( eager.diff( t ).removed.empty() );
+		EXPECT_EQ( 5u , eager.get_entry_count() );
+	}
+	std::remove( dictionary.c_str() );
+}
+
+TEST(TrieTests, ParallelSaveAndLoad)
+{
+	std::string dictionary = testing::TempDir() + "trie_tests_parallel.dict";
+	std::remove( dictionary.c_str() );
+
+	// words with many different first characters, so that the segments are split in several groups
+	std::vector< std::vector<uint8_t> > words;
+	{
+		ScoredTrie<uint8_t> t( dictionary );
+		for (int i = 0; i < 2000; i++)
+		{
+			std::string w = std::string( 1, (char) ('!' + (i * 7) % 90) ) + std::to_string( i * 31 );
+			std::vector<uint8_t> word( w.begin(), w.end() );
+			word.push_back( 0 );
+			std::vector<uint8_t> translation( word.rbegin() + 1, word.rend() );
+			translation.push_back( 0 );
+			t.add_word( word.data(), translation.data() );
+			words.push_back( word );
+		}
+		t.add_word( (const uint8_t*) "", (const uint8_t*) "empty" );
+		t.set_score( words[7].data(), 9 );
+		t.enable_reverse_index();
+
+		t.save_changes();
+		std::ifstream sequential( dictionary, std::ios::binary );
+		std::string sequential_bytes( (std::istreambuf_iterator<char>(sequential)), std::istreambuf_iterator<char>() );
+
+		// same file, no matter how many threads write it
+		t.save_changes( 4 );
+		std::ifstream parallel( dictionary, std::ios::binary );
+		std::string parallel_bytes( (std::istreambuf_iterator<char>(parallel)), std::istreambuf_iterator<char>() );
+		EXPECT_EQ( sequential_bytes , parallel_bytes );
+	}
+	{
+		ScoredTrie<uint8_t> eager( dictionary );
+		ScoredTrie<uint8_t> t( dictionary, trie::LoadMode::parallel, 0, 4 );
+		EXPECT_EQ( 0u , t.get_pending_count() );
+		EXPECT_EQ( 2001u , t.get_entry_count() );
+		EXPECT_EQ( 9u , t.get_score( words[7].data() ) );
+		EXPECT_TRUE( t.has_reverse_index() );
+
+		trie::TrieDiff<uint8_t> d = eager.diff( t );
+		EXPECT_TRUE( d.added.empty() && d.removed.empty() && d.changed.empty() );
+
+		std::vector<uint8_t> translation( words[100].rbegin() + 1, words[100].rend() );
+		translation.push_back( 0 );
+		EXPECT_EQ( 1u , t.search_translation( translation ).size() );
+		EXPECT_EQ( 2001u , t.get_prefix_words( (const uint8_t*) "", -1 ).size() );
+	}
+	std::remove( dictionary.c_str() );
+	{
+		trie::Trie<uint8_t, uint32_t> t( dictionary );
+		for (int i = 0; i < 90; i++)
+		{
+			std::string w = std::string( 1, (char) ('!' + i) ) + "w";
+			t.add_word( (const uint8_t*) w.c_str(), (uint32_t) i );
+		}
+		t.save_changes();
+	}
+	{
+		// the last segment is read by another thread, its broken translation size is thrown on this one
+		std::fstream file( dictionary, std::ios::in | std::ios::out | std::ios::binary );
+		uint64_t index_position, segments_count, segment_offset;
+		uint16_t translation_size = 3;
+		file.seekg( -2 * (long) sizeof(uint64_t), std::ios::end );
+		file.read( (char*) &index_position, sizeof(uint64_t) );
+		file.seekg( (long) index_position, std::ios::beg );
+		file.read( (char*) &segments_count, sizeof(uint64_t) );
+		file.seekg( (long) (index_position + sizeof(uint64_t) + (segments_count - 1) * (1 + 2 * sizeof(uint64_t)) + 1), std::ios::beg );
+		file.read( (char*) &segment_offset, sizeof(uint64_t) );
+		file.seekp( (long) (segment_offset + 1 + 2), std::ios::beg );
+		file.write( (const char*) &translation_size, sizeof(uint16_t) );
+		file.close();
+
+		EXPECT_THROW( (trie::Trie<uint8_t, uint32_t>( dictionary, trie::LoadMode::parallel, 0, 4 )), trie::ErrorReadingDictionaryException );
+		EXPECT_THROW( (trie::Trie<uint8_t, uint32_t>( dictionary )), trie::ErrorReadingDictionaryException );
+	}
+	std::remove( dictionary.c_str() );
+}
+
+TEST(TrieTests, WordFilter)
+{
+	std::string dictionary = testing::TempDir() + "trie_tests_filter.dict";
+	std::remove( dictionary.c_str() );
+
+	std::vector<uint8_t> x = {'x',0};
+	std::vector< std::vector<uint8_t> > words;
+	for (int i = 0; i < 3000; i++)
+	{
+		std::string w = std::string( 1, (char) ('a' + i % 20) ) + std::to_string( i * 13 );
+		words.push_back( std::vector<uint8_t>( w.begin(), w.end() ) );
+		words.back().push_back( 0 );
+	}
+
+	{
+		trie::Trie<uint8_t> t( dictionary );
+		EXPECT_FALSE( t.has_word_filter() );
+		EXPECT_EQ( 0u , t.get_stats().word_filter_bytes );
+		for (size_t i = 0; i < 1000; i++)
+			t.add_word( words[i], x );
+
+		// words added before and after the filter is built, the filter grows with them
+		t.enable_word_filter();
+		EXPECT_TRUE( t.has_word_filter() );
+		for (size_t i = 1000; i < words.size(); i++)
+			t.add_word( words[i], x );
+		EXPECT_LT( 0u , t.get_stats().word_filter_bytes );
+
+		for (size_t i = 0; i < words.size(); i++)
+			EXPECT_EQ( x , t.search_word( words[i] ) );
+		EXPECT_TRUE( t.search_word( (const uint8_t*) "a1" ).empty() );
+		EXPECT_TRUE( t.search_word( (const uint8_t*) "zz" ).empty() );
+
+		// deleted words are never found, the filter is built again once most of its words are deleted
+		trie::Trie<uint8_t> before( t );
+		for (size_t i = 0; i < 2000; i++)
+			t.delete_word( words[i] );
+		EXPECT_EQ( 50u , t.delete_prefix( (const uint8_t*) "a" ) );
+		for (size_t i = 0; i < words.size(); i++)
+			EXPECT_EQ( (i < 2000 || words[i][0] == 'a') ? std::vector<uint8_t>() : x , t.search_word( words[i] ) );
+		EXPECT_EQ( x , before.search_word( words[0] ) );
+
+		t.compact();
+		for (size_t i = 2000; i < words.size(); i++)
+			EXPECT_EQ( (words[i][0] == 'a') ? std::vector<uint8_t>() : x , t.search_word( words[i] ) );
+
+		t.save_changes();
+	}
+	{
+		// the filter is saved with the file, eager and lazy Tries read it
+		trie::Trie<uint8_t> eager( dictionary );
+		EXPECT_TRUE( eager.has_word_filter() );
+		EXPECT_EQ( 950u , eager.get_entry_count() );
+		EXPECT_EQ( x , eager.search_word( words[2001] ) );
+		EXPECT_TRUE( eager.search_word( words[0] ).empty() );
+
+		// words that the filter rules out don't add their segment
+		trie::Trie<uint8_t> t( dictionary, trie::LoadMode::lazy );
+		EXPECT_TRUE( t.has_word_filter() );
+		EXPECT_EQ( 950u , t.get_pending_count() );
+		EXPECT_TRUE( t.search_word( (const uint8_t*) "b1" ).empty() );
+		EXPECT_EQ( 950u , t.get_pending_count() );
+		EXPECT_EQ( x , t.search_word( words[2001] ) );
+		EXPECT_GT( 950u , t.get_pending_count() );
+
+		t.disable_word_filter();
+		EXPECT_EQ( 0u , t.get_stats().word_filter_bytes );
+	}
+	{
+		// a filter with more blocks than the file keeps is a broken file, nothing is allocated for it
+		std::fstream file( dictionary, std::ios::in | std::ios::out | std::ios::binary );
+		uint64_t index_position, segments_count, block_count = (uint64_t) 1 << 40;
+		file.seekg( -2 * (long) sizeof(uint64_t), std::ios::end );
+		file.read( (char*) &index_position, sizeof(uint64_t) );
+		file.seekg( (long) index_position, std::ios::beg );
+		file.read( (char*) &segments_count, sizeof(uint64_t) );
+		file.seekp( (long) (index_position + sizeof(uint64_t) + segments_count * (1 + 2 * sizeof(uint64_t))), std::ios::beg );
+		file.write( (const char*) &block_count, sizeof(uint64_t) );
+		file.close();
+
+		EXPECT_THROW( trie::Trie<uint8_t> t( dictionary ), trie::ErrorReadingDictionaryException );
+		EXPECT_THROW( trie::Trie<uint8_t> t( dictionary, trie::LoadMode::lazy ), trie::ErrorReadingDictionaryException );
+	}
+	std::remove( dictionary.c_str() );
+}
+
+TEST(TrieTests, WordIndex)
+{
+	std::string dictionary = testing::TempDir() + "trie_tests_word_index.dict";
+	std::remove( dictionary.c_str() );
+
+	std::vector<uint8_t> x = {'x',0}, y = {'y',0};
+	{
+		ScoredTrie<uint8_t> t( dictionary );
+		for (const char* w : { "", "a", "ab", "abc", "abd", "b" })
+			t.add_word( (const uint8_t*) w, x.data() );
+
+		t.enable_word_index();
+		EXPECT_TRUE( t.has_word_index() );
+		EXPECT_LT( 0u , t.get_stats().word_index_bytes );
+		EXPECT_EQ( x , t.search_word( (const uint8_t*) "ab" ) );
+		EXPECT_EQ( x , t.search_word( (const uint8_t*) "" ) );
+		EXPECT_TRUE( t.search_word( (const uint8_t*) "abe" ).empty() );
+
+		// the copy keeps the TrieNodes of its words when the Trie copies the ones it changes
+		ScoredTrie<uint8_t> copy( t );
+		t.delete_word( (const uint8_t*) "ab" );
+		t.add_word( (const uint8_t*) "abe", y.data() );
+		t.set_score( (const uint8_t*) "abc", 3 );
+		EXPECT_TRUE( t.search_word( (const uint8_t*) "ab" ).empty() );
+		EXPECT_EQ( y , t.search_word( (const uint8_t*) "abe" ) );
+		EXPECT_EQ( x , copy.search_word( (const uint8_t*) "ab" ) );
+		EXPECT_TRUE( copy.search_word( (const uint8_t*) "abe" ).empty() );
+
+		// TrieNodes moved or deleted all at once
+		EXPECT_EQ( 1u , t.delete_prefix( (const uint8_t*) "abd" ) );
+		EXPECT_EQ( 1u , t.delete_prefix( (const uint8_t*) "b" ) );
+		EXPECT_TRUE( t.search_word( (const uint8_t*) "abd" ).empty() );
+		t.compact();
+		EXPECT_EQ( y , t.search_word( (const uint8_t*) "abe" ) );
+		EXPECT_EQ( 3u , t.merge_from( copy ) );
+		EXPECT_EQ( x , t.search_word( (const uint8_t*) "abd" ) );
+		EXPECT_EQ( x , t.search_word( (const uint8_t*) "ab" ) );
+		t.save_changes();
+	}
+	{
+		// the index is built again while the entries are read
+		trie::Trie<uint8_t> t( dictionary, trie::LoadMode::lazy );
+		EXPECT_TRUE( t.has_word_index() );
+		EXPECT_EQ( x , t.search_word( (const uint8_t*) "abc" ) );
+		EXPECT_EQ( y , t.search_word( (const uint8_t*) "abe" ) );
+		EXPECT_TRUE( t.search_word( (const uint8_t*) "c" ).empty() );
+
+		t.disable_word_index();
+		EXPECT_EQ( 0u , t.get_stats().word_index_bytes );
+		EXPECT_EQ( x , t.search_word( (const uint8_t*) "b" ) );
+	}
+	std::remove( dictionary.c_str() );
+}
@@ -0,0 +1,58 @@
+#include "trie/trie.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+TEST(Utf8Tests, Decode)
+{
+	// 1, 2, 3 and 4 byte sequences, around the ASCII fast path
+	std::string text = "abcdefgh\xce\xb1\xce\xb2 \xe2\x82\xac ijklmnopqrstuvwx\xf0\x9f\x98\x80z";
+
+	std::vector<uint32_t> utf32;
+	EXPECT_TRUE( trie::utf8_decode( text.data(), text.size(), utf32) );
+	std::vector<uint32_t> expected32 = { 'a','b','c','d','e','f','g','h', 0x3B1, 0x3B2, ' ', 0x20AC, ' ',
+										 'i','j','k','l','m','n','o','p','q','r','s','t','u','v','w','x', 0x1F600, 'z' };
+	EXPECT_EQ( expected32 , utf32 );
+
+	std::vector<uint16_t> utf16;
+	EXPECT_TRUE( trie::utf8_decode( text.data(), text.size(), utf16) );
+	EXPECT_EQ( expected32.size() + 1 , utf16.size() );
+	EXPECT_EQ( 0xD83D , utf16[29] );
+	EXPECT_EQ( 0xDE00 , utf16[30] );
+
+	std::vector<uint8_t> utf8;
+	EXPECT_TRUE( trie::utf8_decode( text.data(), text.size(), utf8) );
+	EXPECT_EQ( text , std::string( utf8.begin(), utf8.end() ) );
+
+	// back to UTF-8
+	std::string encoded;
+	trie::utf8_encode( utf32.data(), utf32.size(), encoded);
+	EXPECT_EQ( text , encoded );
+	encoded.clear();
+	trie::utf8_encode( utf16.data(), utf16.size(), encoded);
+	EXPECT_EQ( text , encoded );
+
+	// invalid: cut sequence, overlong form, surrogate, above 0x10FFFF, lonely continuation byte
+	for (std::string invalid : { "ab\xce", "\xc0\xaf", "\xed\xa0\x80", "\xf4\x90\x80\x80", "abcdefghij\x80" })
+	{
+		std::vector<uint32_t> output( 1, 7 );
+		EXPECT_FALSE( trie::utf8_decode( invalid.data(), invalid.size(), output) );
+		EXPECT_EQ( std::vector<uint32_t>( 1, 7 ) , output );
+	}
+}
+
+TEST(Utf8Tests, Words)
+{
+	trie::Trie<uint32_t> t;
+	std::vector<uint32_t> word, translation;
+	EXPECT_TRUE( trie::utf8_to_word( std::string( "\xce\xb3\xce\xac\xcf\x84\xce\xb1" ), word) );
+	EXPECT_EQ( 5u , word.size() );
+	EXPECT_TRUE( trie::utf8_to_word( std::string( "cat" ), translation) );
+	EXPECT_TRUE( t.add_word( word, translation ) );
+
+	EXPECT_EQ( "cat" , trie::word_to_utf8( t.search_word( word ) ) );
+	EXPECT_EQ( "\xce\xb3\xce\xac\xcf\x84\xce\xb1" , trie::word_to_utf8( t.get_range_words( NULL, NULL, 1 )[0] ) );
+	EXPECT_FALSE( trie::utf8_to_word( std::string( "\xff" ), word) );
+}
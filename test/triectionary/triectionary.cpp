@@ -25,6 +25,7 @@ int main(void)
 		printf("\\s w          ||| search for the translation of word w\n");
 		printf("\\d w          ||| delete word w and its translation\n");
 		printf("\\p w -> count ||| get count words that begin with word w\n");
+		printf("\\l w          ||| find the longest saved word that is a prefix of w\n");
 		printf("\\c            ||| get total number of saved translations in Trie\n");
 		printf("\\i filename   ||| import csv file of format (word,translation)\n");
 		printf("\\z filename   ||| delete csv file of format (word,translation) - translation is ignored, used mainly for debugging\n");
@@ -107,6 +108,25 @@ int main(void)
 				}
 				printf("\n\n");
 			}
+			else if (!input.compare("\\l"))
+			{
+				printf("Searching longest prefix for: (word -> %s)\n", input1.c_str());
+
+				arg1.insert( arg1.end(), input1.begin(), input1.begin() + (input1.size() + 1) );
+
+				uint32_t matched_length;
+				arg2 = t->longest_prefix_match( arg1, matched_length );
+
+				if ( arg2.size() != 0 )
+				{
+					printf("%s -> ", input1.substr( 0, matched_length).c_str());
+					for (uint32_t i=0; i < arg2.size(); i++ )
+						printf("%c", arg2[i]);
+					printf("\n\n");
+				}
+				else
+					printf("no prefix of %s exists in this dictionary\n\n", input1.c_str());
+			}
 			else if (!input.compare("\\c"))
 			{
 				printf("Totally %ld entries in Trie\n\n", t->get_entry_count());
@@ -115,7 +135,11 @@ int main(void)
 			{
 				try
 				{
-					t->insert_from_csv(input1);
+					trie::CsvStats stats = t->insert_from_csv(input1);
+					printf("%ld records, %ld inserted, %ld rejected, %ld malformed lines", stats.records, stats.accepted, stats.rejected, stats.malformed);
+					if (stats.malformed > 0)
+						printf(" (first at line %ld)", stats.first_malformed_line);
+					printf("\n");
 				}
 				catch (trie::ErrorOpeningCsvException eoce)
 				{
@@ -127,7 +151,8 @@ int main(void)
 			{
 				try
 				{
-					t->delete_from_csv(input1);
+					trie::CsvStats stats = t->delete_from_csv(input1);
+					printf("%ld records, %ld deleted, %ld rejected, %ld malformed lines\n", stats.records, stats.accepted, stats.rejected, stats.malformed);
 				}
 				catch (trie::ErrorOpeningCsvException eoce)
 				{
@@ -231,7 +256,7 @@ bool parse_input( std::string& input, std::string& input1, std::string& input2)
 				}
 			}
 		}
-		else if ( (!strings[0].compare("\\s")) || (!strings[0].compare("\\d")) || (!strings[0].compare("\\i")) || (!strings[0].compare("\\z")) )
+		else if ( (!strings[0].compare("\\s")) || (!strings[0].compare("\\d")) || (!strings[0].compare("\\l")) || (!strings[0].compare("\\i")) || (!strings[0].compare("\\z")) )
 		{
 			input = strings[0];
 			input1 = "";
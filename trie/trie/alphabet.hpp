@@ -0,0 +1,153 @@
+#ifndef TRIE_ALPHABET_H_
+#define TRIE_ALPHABET_H_
+
+#include <limits>
+#include <stdint.h>
+#include <type_traits>
+
+namespace trie
+{
+
+/* An alphabet maps the characters given to the Trie to the letters kept in the TrieNodes.
+	Letters are dense integers in [0, size), so TrieNodes are sized and searched for size letters only.
+	The mapping keeps the order of the characters, so the Trie keeps its lexicographic order.
+
+	Every alphabet offers:
+		letter_type     : smallest unsigned integer type that can keep all letters
+		size            : number of letters
+		last_letter()   : letter size-1
+		to_character(l) : character of letter l
+		lower_bound(c)  : number of letters with a character smaller than c
+						  (the letter of c, if the alphabet contains c) */
+
+/* smallest unsigned integer type for the letters of an alphabet of the given size */
+template <uint64_t alphabet_size>
+using letter_type_for =
+	typename std::conditional< (alphabet_size <= 256), uint8_t,
+	typename std::conditional< (alphabet_size <= 65536), uint16_t,
+	uint32_t >::type >::type;
+
+/* default alphabet, every value of character_t is a letter of itself */
+template <class character_t>
+struct FullAlphabet
+{
+	using letter_type = character_t;
+
+	static constexpr uint64_t size = (uint64_t) std::numeric_limits<character_t>::max() + 1;
+
+	static constexpr letter_type last_letter()
+	{
+		return std::numeric_limits<character_t>::max();
+	}
+
+	static constexpr character_t to_character( letter_type l)
+	{
+		return l;
+	}
+
+	static constexpr uint64_t lower_bound( character_t c)
+	{
+		return c;
+	}
+};
+
+/* consecutive characters first, first+1, ..., last (e.g. 'a' to 'z') */
+template <class character_t, character_t first, character_t last>
+struct RangeAlphabet
+{
+	static_assert( first <= last, "RangeAlphabet needs first <= last" );
+
+	using letter_type = letter_type_for< (uint64_t) last - first + 1 >;
+
+	static constexpr uint64_t size = (uint64_t) last - first + 1;
+
+	static constexpr letter_type last_letter()
+	{
+		return last - first;
+	}
+
+	static constexpr character_t to_character( letter_type l)
+	{
+		return first + l;
+	}
+
+	static constexpr uint64_t lower_bound( character_t c)
+	{
+		return (c < first) ? 0 : ( (c > last) ? size : (uint64_t) (c - first) );
+	}
+};
+
+/* checks that the characters of a ListAlphabet are given in increasing order */
+constexpr bool is_increasing()
+{
+	return true;
+}
+template <class character_t>
+constexpr bool is_increasing( character_t)
+{
+	return true;
+}
+template <class character_t, class... rest_t>
+constexpr bool is_increasing( character_t a, character_t b, rest_t... rest)
+{
+	return (a < b) && is_increasing( b, rest...);
+}
+
+/* any set of characters, given in increasing order (e.g. the code points used by a dictionary) */
+template <class character_t, character_t... characters>
+struct ListAlphabet
+{
+	static_assert( sizeof...(characters) > 0, "ListAlphabet needs at least one character" );
+	static_assert( is_increasing( characters... ), "ListAlphabet needs characters in increasing order" );
+
+	using letter_type = letter_type_for< sizeof...(characters) >;
+
+	static constexpr uint64_t size = sizeof...(characters);
+
+	/* characters of the alphabet, indexed by their letter */
+	static constexpr character_t table[ sizeof...(characters) ] = { characters... };
+
+	static constexpr letter_type last_letter()
+	{
+		return size - 1;
+	}
+
+	static constexpr character_t to_character( letter_type l)
+	{
+		return table[l];
+	}
+
+	/* binary search in table */
+	static constexpr uint64_t lower_bound( character_t c, uint64_t low = 0, uint64_t high = size)
+	{
+		return (low == high) ? low :
+			   (table[ (low+high)/2 ] < c) ? lower_bound( c, (low+high)/2 + 1, high) : lower_bound( c, low, (low+high)/2);
+	}
+};
+
+template <class character_t, character_t... characters>
+constexpr character_t ListAlphabet<character_t, characters...>::table[ sizeof...(characters) ];
+
+template <class character_t>
+constexpr uint64_t FullAlphabet<character_t>::size;
+template <class character_t, character_t first, character_t last>
+constexpr uint64_t RangeAlphabet<character_t, first, last>::size;
+template <class character_t, character_t... characters>
+constexpr uint64_t ListAlphabet<character_t, characters...>::size;
+
+/* map character c to its letter in alphabet_t
+	return false if the alphabet doesn't contain c */
+template <class alphabet_t, class character_t>
+inline bool to_letter( character_t c, typename alphabet_t::letter_type& letter)
+{
+	uint64_t position = alphabet_t::lower_bound(c);
+	if ( (position == alphabet_t::size) || (alphabet_t::to_character( (typename alphabet_t::letter_type) position ) != c) )
+		return false;
+
+	letter = (typename alphabet_t::letter_type) position;
+	return true;
+}
+
+}
+
+#endif
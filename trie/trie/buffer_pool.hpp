@@ -0,0 +1,212 @@
+#ifndef TRIE_BUFFER_POOL_H_
+#define TRIE_BUFFER_POOL_H_
+
+#include <list>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "trie/exceptions.hpp"
+
+namespace trie
+{
+
+/* counters of a BufferPool (see PagedTrie::get_stats) */
+struct BufferPoolStats
+{
+	uint64_t hits;			// page accesses served from memory
+	uint64_t misses;		// page accesses that had to read the page from the file
+	uint64_t evictions;		// pages removed from memory to make room for other pages
+	uint64_t writes;		// changed pages written back in the file
+};
+
+/* keeps up to capacity pages (fixed-size blocks) of a file in memory, the least recently used page is evicted first
+	changed (dirty) pages are written back when they are evicted or flushed, pages that didn't change are never written
+	a page that can't be written back stays changed in memory, and ErrorWritingDictionaryException is thrown
+	read and write copy bytes in and out of the cached pages, so no page has to stay in memory between two calls */
+class BufferPool
+{
+private:
+	struct frame
+	{
+		uint64_t page;
+		bool dirty;
+		std::vector<char> data;
+	};
+
+	std::string file_name;
+	FILE* file;
+	uint32_t page_size;
+	size_t capacity;
+
+	/* pages of the file, including pages added by allocate and not written yet */
+	uint64_t page_count;
+
+	/* cached pages, most recently used first, and the frame of every cached page */
+	std::list<frame> frames;
+	std::unordered_map< uint64_t, std::list<frame>::iterator > lookup;
+
+	BufferPoolStats stats;
+
+	/* return the frame of a page, reading the page from the file if it is not cached
+		pages after the end of the file start with zeros */
+	frame& fetch( uint64_t page);
+
+	void write_back( frame& f);
+
+public:
+	/* the file stays open and owned by the caller, capacity is at least 1 page
+		file_name is only used to report errors */
+	BufferPool( std::string file_name, FILE* file, uint32_t page_size, size_t capacity, uint64_t page_count);
+
+	/* copies would write the same pages back in the file */
+	BufferPool( const BufferPool&) = delete;
+	BufferPool& operator=( const BufferPool&) = delete;
+
+	/* copy size bytes starting at position offset of the file (which can cross pages) from (to) the cached pages */
+	void read( uint64_t offset, void* destination, uint64_t size);
+	void write( uint64_t offset, const void* source, uint64_t size);
+
+	/* add count pages after the last page of the file, return the number of the first one */
+	uint64_t allocate( uint64_t count);
+
+	/* write all changed pages back in the file */
+	void flush();
+
+	uint64_t get_page_count();
+	uint64_t get_cached_count();
+	BufferPoolStats get_stats();
+};
+
+inline BufferPool::BufferPool( std::string file_name, FILE* file, uint32_t page_size, size_t capacity, uint64_t page_count)
+{
+	this->file_name = file_name;
+	this->file = file;
+	this->page_size = page_size;
+	this->capacity = std::max( capacity, (size_t) 1);
+	this->page_count = page_count;
+	this->stats = BufferPoolStats();
+}
+
+inline BufferPool::frame& BufferPool::fetch( uint64_t page)
+{
+	auto cached = this->lookup.find( page );
+	if (cached != this->lookup.end())
+	{
+		this->stats.hits++;
+		this->frames.splice( this->frames.begin(), this->frames, cached->second);
+		return this->frames.front();
+	}
+
+	this->stats.misses++;
+
+	// reuse the buffer of the least recently used page when the pool is full
+	if (this->frames.size() == this->capacity)
+	{
+		frame& victim = this->frames.back();
+		if (victim.dirty)
+			this->write_back( victim );
+		this->lookup.erase( victim.page );
+		this->frames.splice( this->frames.begin(), this->frames, std::prev( this->frames.end() ));
+		this->stats.evictions++;
+	}
+	else
+	{
+		this->frames.push_front( frame() );
+		this->frames.front().data.resize( this->page_size );
+	}
+
+	frame& f = this->frames.front();
+	f.page = page;
+	f.dirty = false;
+	this->lookup[page] = this->frames.begin();
+
+	size_t read = 0;
+	if (fseek( this->file, (long) (page * this->page_size), SEEK_SET) == 0)
+		read = fread( f.data.data(), 1, this->page_size, this->file);
+	std::fill( f.data.begin() + read, f.data.end(), 0);
+
+	return f;
+}
+
+inline void BufferPool::write_back( frame& f)
+{
+	if ( (fseek( this->file, (long) (f.page * this->page_size), SEEK_SET) != 0) ||
+		 (fwrite( f.data.data(), 1, this->page_size, this->file) != this->page_size) || (fflush( this->file ) != 0) )
+		throw ErrorWritingDictionaryException( this->file_name, "Can't write a page back");
+
+	f.dirty = false;
+	this->stats.writes++;
+}
+
+inline void BufferPool::read( uint64_t offset, void* destination, uint64_t size)
+{
+	char* write = (char*) destination;
+	while (size > 0)
+	{
+		uint64_t in_page = offset % this->page_size;
+		uint64_t part = std::min( size, (uint64_t) this->page_size - in_page);
+
+		frame& f = this->fetch( offset / this->page_size );
+		memcpy( write, f.data.data() + in_page, part);
+
+		write += part;
+		offset += part;
+		size -= part;
+	}
+}
+
+inline void BufferPool::write( uint64_t offset, const void* source, uint64_t size)
+{
+	const char* read = (const char*) source;
+	while (size > 0)
+	{
+		uint64_t in_page = offset % this->page_size;
+		uint64_t part = std::min( size, (uint64_t) this->page_size - in_page);
+
+		frame& f = this->fetch( offset / this->page_size );
+		memcpy( f.data.data() + in_page, read, part);
+		f.dirty = true;
+
+		read += part;
+		offset += part;
+		size -= part;
+	}
+}
+
+inline uint64_t BufferPool::allocate( uint64_t count)
+{
+	uint64_t first = this->page_count;
+	this->page_count += count;
+	return first;
+}
+
+inline void BufferPool::flush()
+{
+	for (frame& f : this->frames)
+		if (f.dirty)
+			this->write_back( f );
+}
+
+inline uint64_t BufferPool::get_page_count()
+{
+	return this->page_count;
+}
+
+inline uint64_t BufferPool::get_cached_count()
+{
+	return this->frames.size();
+}
+
+inline BufferPoolStats BufferPool::get_stats()
+{
+	return this->stats;
+}
+
+}
+
+#endif
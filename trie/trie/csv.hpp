@@ -0,0 +1,350 @@
+#ifndef TRIE_CSV_H_
+#define TRIE_CSV_H_
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "trie/exceptions.hpp"
+
+namespace trie
+{
+
+/* counters of a csv import (see Trie::insert_from_csv, Trie::delete_from_csv) */
+struct CsvStats
+{
+	uint64_t records;				// lines (records) of the form word,translation
+	uint64_t accepted;				// records inserted (deleted) in the Trie
+	uint64_t rejected;				// records that add_word (delete_word) refused, e.g. existing words or too long words
+	uint64_t malformed;				// lines without a separator, or with broken quotes
+	uint64_t invalid_encoding;		// records that are not valid UTF-8 (Tries of characters bigger than 1 byte only)
+	uint64_t first_malformed_line;	// line number of the 1st malformed line, starting from 1 (0 if there is none)
+};
+
+/* a field of a csv record, pointing inside the buffer of the CsvReader
+	valid until the next call of CsvReader::next
+	the character right after the field (data[length]) belongs to the reader and can be overwritten (e.g. with an end_of_string) */
+struct CsvField
+{
+	char* data;
+	uint32_t length;
+};
+
+/* reads records of the form word,translation from a csv file, in large blocks
+	- the 1st comma of a line is the separator, the translation keeps any other comma
+	- fields can be quoted ("a,b"), with "" for a quote character, and can then contain commas and new lines
+	- lines can end with \n or \r\n, empty lines are ignored
+	lines and separators are found with memchr, which scans many bytes per step
+	fields are never copied, quoted fields with "" are unescaped in place */
+class CsvReader
+{
+private:
+	FILE* file;
+	bool end_of_file;
+
+	/* block of the file, [begin, end) not read yet
+		one extra byte is always kept after end, so that the last field of the file can be followed by an end_of_string */
+	std::vector<char> buffer;
+	char* begin;
+	char* end;
+
+	CsvStats stats;
+	uint64_t line;
+
+	enum parse_result
+	{
+		RECORD,
+		SKIP,
+		MALFORMED,
+		INCOMPLETE
+	};
+
+	/* read more of the file after the unread part of the buffer, make buffer bigger if it is full
+		return false if nothing more could be read */
+	bool refill();
+
+	/* find the closing quote of a quoted field that starts after position
+		return NULL if the field doesn't end before end */
+	const char* find_closing_quote( const char* position);
+
+	/* remove quotes and escaping of a quoted field (closing_quote included) in place */
+	void unescape( CsvField& field, char* closing_quote);
+
+	/* a quote that is never closed is malformed only at the end of the file, the rest of the file is skipped */
+	parse_result unterminated_quote( const char* quote, char*& next, uint64_t& lines);
+
+	/* try to read one record in [begin, end) */
+	parse_result parse( CsvField& word, CsvField& translation, char*& next, uint64_t& lines);
+
+public:
+	CsvReader( std::string filename, size_t block_size = 1 << 20);
+	~CsvReader();
+
+	/* read the next record of the file
+		malformed lines are counted and skipped
+		return false when there are no more records */
+	bool next( CsvField& word, CsvField& translation);
+
+	/* counters of all lines read so far (accepted and rejected are left to the caller) */
+	CsvStats get_stats();
+};
+
+inline CsvReader::CsvReader( std::string filename, size_t block_size)
+{
+	this->file = fopen( filename.c_str(), "rb");
+	if (this->file == NULL)
+		throw ErrorOpeningCsvException(filename);
+
+	this->end_of_file = false;
+	this->buffer.resize( std::max( block_size, (size_t) 2) + 1 );
+	this->begin = this->buffer.data();
+	this->end = this->buffer.data();
+
+	this->stats = CsvStats();
+	this->line = 1;
+}
+
+inline CsvReader::~CsvReader()
+{
+	fclose( this->file );
+}
+
+inline bool CsvReader::refill()
+{
+	if (this->end_of_file)
+		return false;
+
+	// move the unread part to the start of the buffer
+	size_t unread = this->end - this->begin;
+	std::copy( this->begin, this->end, this->buffer.data() );
+
+	// a single record bigger than the buffer
+	if (unread == this->buffer.size() - 1)
+		this->buffer.resize( (this->buffer.size() - 1) * 2 + 1 );
+
+	size_t read = fread( this->buffer.data() + unread, 1, this->buffer.size() - 1 - unread, this->file);
+	if (read == 0)
+		this->end_of_file = true;
+
+	this->begin = this->buffer.data();
+	this->end = this->buffer.data() + unread + read;
+
+	return read != 0;
+}
+
+inline const char* CsvReader::find_closing_quote( const char* position)
+{
+	while (true)
+	{
+		const char* quote = (const char*) memchr( position, '"', this->end - position);
+		if (quote == NULL || quote + 1 == this->end)
+			return (quote != NULL && this->end_of_file) ? quote : NULL;
+
+		// "" is an escaped quote
+		if (quote[1] != '"')
+			return quote;
+
+		position = quote + 2;
+	}
+}
+
+inline void CsvReader::unescape( CsvField& field, char* closing_quote)
+{
+	char* read = field.data;
+	char* write = field.data;
+	while (read != closing_quote)
+	{
+		char* quote = (char*) memchr( read, '"', closing_quote - read);
+		if (quote == NULL)
+			quote = closing_quote;
+
+		write = std::copy( read, quote, write);
+		read = quote;
+
+		// keep one quote of every ""
+		if (read != closing_quote)
+		{
+			*(write++) = '"';
+			read += 2;
+		}
+	}
+
+	field.length = write - field.data;
+}
+
+inline CsvReader::parse_result CsvReader::unterminated_quote( const char* quote, char*& next, uint64_t& lines)
+{
+	if (!this->end_of_file)
+		return INCOMPLETE;
+
+	lines += std::count( quote, (const char*) this->end, '\n') + 1;
+	next = this->end;
+
+	return MALFORMED;
+}
+
+inline CsvReader::parse_result CsvReader::parse( CsvField& word, CsvField& translation, char*& next, uint64_t& lines)
+{
+	char* position = this->begin;
+	lines = 0;
+
+	// end of the current line, NULL if it isn't in the buffer yet
+	char* line_end = (char*) memchr( position, '\n', this->end - position);
+	if (line_end == NULL && !this->end_of_file)
+		return INCOMPLETE;
+	if (line_end == NULL)
+		line_end = this->end;
+
+	// empty lines
+	if ( (position == line_end) || (position + 1 == line_end && *position == '\r') )
+	{
+		next = (line_end == this->end) ? line_end : line_end + 1;
+		lines = 1;
+		return SKIP;
+	}
+
+	// 1) word
+	char* word_closing_quote = NULL;
+	if (*position == '"')
+	{
+		word_closing_quote = (char*) this->find_closing_quote( position + 1 );
+		if (word_closing_quote == NULL)
+			return this->unterminated_quote( position, next, lines);
+
+		word.data = position + 1;
+		position = word_closing_quote + 1;
+
+		// the quoted word can contain new lines
+		lines += std::count( word.data, word_closing_quote, '\n');
+		if (lines > 0)
+		{
+			line_end = (char*) memchr( position, '\n', this->end - position);
+			if (line_end == NULL && !this->end_of_file)
+				return INCOMPLETE;
+			if (line_end == NULL)
+				line_end = this->end;
+		}
+
+		if (position == this->end || *position != ',')
+		{
+			next = (line_end == this->end) ? line_end : line_end + 1;
+			lines++;
+			return MALFORMED;
+		}
+	}
+	else
+	{
+		char* comma = (char*) memchr( position, ',', line_end - position);
+		if (comma == NULL)
+		{
+			next = (line_end == this->end) ? line_end : line_end + 1;
+			lines++;
+			return MALFORMED;
+		}
+
+		word.data = position;
+		word.length = comma - position;
+		position = comma;
+	}
+
+	// skip the separator
+	position++;
+
+	// 2) translation
+	char* translation_closing_quote = NULL;
+	if (position != this->end && *position == '"')
+	{
+		translation_closing_quote = (char*) this->find_closing_quote( position + 1 );
+		if (translation_closing_quote == NULL)
+			return this->unterminated_quote( position, next, lines);
+
+		translation.data = position + 1;
+		lines += std::count( translation.data, translation_closing_quote, '\n');
+		position = translation_closing_quote + 1;
+
+		// nothing else than the end of the line after the closing quote
+		if (position != this->end && *position == '\r')
+			position++;
+		if (position == this->end && !this->end_of_file)
+			return INCOMPLETE;
+		if (position != this->end && *position != '\n')
+		{
+			line_end = (char*) memchr( position, '\n', this->end - position);
+			if (line_end == NULL && !this->end_of_file)
+				return INCOMPLETE;
+			next = (line_end == NULL) ? this->end : line_end + 1;
+			lines++;
+			return MALFORMED;
+		}
+
+		next = (position == this->end) ? position : position + 1;
+	}
+	else
+	{
+		// unquoted translation ends with the line
+		translation.data = position;
+		translation.length = line_end - position;
+		if (translation.length > 0 && translation.data[translation.length - 1] == '\r')
+			translation.length--;
+
+		next = (line_end == this->end) ? line_end : line_end + 1;
+	}
+	lines++;
+
+	// the record is complete, quoted fields can be changed now
+	if (word_closing_quote != NULL)
+		this->unescape( word, word_closing_quote);
+	if (translation_closing_quote != NULL)
+		this->unescape( translation, translation_closing_quote);
+
+	return RECORD;
+}
+
+inline bool CsvReader::next( CsvField& word, CsvField& translation)
+{
+	while (true)
+	{
+		if (this->begin == this->end && !this->refill())
+			return false;
+
+		char* next;
+		uint64_t lines;
+		parse_result result = this->parse( word, translation, next, lines);
+
+		if (result == INCOMPLETE)
+		{
+			// read more, the end of the file completes any record
+			if (!this->refill())
+				this->end_of_file = true;
+			continue;
+		}
+
+		if (result == MALFORMED)
+		{
+			this->stats.malformed++;
+			if (this->stats.first_malformed_line == 0)
+				this->stats.first_malformed_line = this->line;
+		}
+
+		this->line += lines;
+		this->begin = next;
+
+		if (result == RECORD)
+		{
+			this->stats.records++;
+			return true;
+		}
+	}
+}
+
+inline CsvStats CsvReader::get_stats()
+{
+	return this->stats;
+}
+
+}
+
+#endif
@@ -46,6 +46,47 @@ public:
 };
 
 
+class ErrorWritingDictionaryException : std::exception
+{
+private:
+	std::string dictionary_name;
+	std::string cause;
+
+public:
+	ErrorWritingDictionaryException( std::string d_n, std::string c) : dictionary_name(d_n), cause(c) {}
+
+	std::string info()
+	{
+		return "Error writing the dictionary file named " + this->dictionary_name + " - " + this->cause;
+	}
+};
+
+
+class ConflictingTriesException : std::exception
+{
+public:
+	std::string info()
+	{
+		return "The given Tries use different end_of_string characters";
+	}
+};
+
+
+class InvalidPatternException : std::exception
+{
+private:
+	std::string cause;
+
+public:
+	InvalidPatternException( std::string c) : cause(c) {}
+
+	std::string info()
+	{
+		return "Invalid pattern - " + this->cause;
+	}
+};
+
+
 class ErrorOpeningCsvException : std::exception
 {
 private:
@@ -60,6 +101,16 @@ public:
 	}
 };
 
+
+class StaticTrieSizeException : std::exception
+{
+public:
+	std::string info()
+	{
+		return "The words of the StaticTrie need more TrieNodes than the given node count";
+	}
+};
+
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,78 @@
+#ifndef TRIE_NODE_OPTIONS_H_
+#define TRIE_NODE_OPTIONS_H_
+
+#include <stdint.h>
+
+namespace trie
+{
+
+/* optional data of the TrieNodes of a Trie, chosen at compile time with the last template parameter of Trie
+		trie::Trie<uint8_t, std::vector<uint8_t>, trie::FullAlphabet<uint8_t>, trie::NodeOptions<true> > t;
+	counts: every TrieNode keeps the number of words in its sub-trie (8 more bytes per TrieNode), needed by count_prefix, rank and select
+	Tries without it keep the smallest TrieNodes, functions that need the number of words of a sub-trie
+	(delete_prefix, merge_from, intersect, save_changes) count them by visiting the sub-trie
+	scores: every TrieNode keeps the score of its word and the biggest score of its sub-trie (8 more bytes per TrieNode),
+	needed by set_score, get_score and top_k_completions, Tries without it ignore the scores of add_word and of dictionary files */
+template <bool counts = false, bool scores = false>
+struct NodeOptions
+{
+	static const bool has_counts = counts;
+	static const bool has_scores = scores;
+};
+
+/* number of words (translations) in the sub-trie of a TrieNode, kept only with NodeOptions counts
+	a base class of TrieNode, so that it takes no memory at all when it is not kept */
+template <bool counts>
+class SubtreeCount
+{
+protected:
+	uint64_t subtree_count;
+
+	SubtreeCount() : subtree_count(0) {}
+
+	uint64_t get_count() { return this->subtree_count; }
+	void add_count( uint64_t n) { this->subtree_count += n; }
+	void remove_count( uint64_t n) { this->subtree_count -= n; }
+	void copy_count( const SubtreeCount& other) { this->subtree_count = other.subtree_count; }
+};
+
+template <>
+class SubtreeCount<false>
+{
+protected:
+	uint64_t get_count() { return 0; }
+	void add_count( uint64_t) {}
+	void remove_count( uint64_t) {}
+	void copy_count( const SubtreeCount&) {}
+};
+
+/* score of the word of a TrieNode (0 if there is none) and biggest score of all words in its sub-trie (including its own one)
+	kept only with NodeOptions scores, a base class of TrieNode same as SubtreeCount */
+template <bool scores>
+class NodeScores
+{
+protected:
+	uint32_t score;
+	uint32_t max_score;
+
+	NodeScores() : score(0), max_score(0) {}
+
+	uint32_t own_score() { return this->score; }
+	void set_own_score( uint32_t s) { this->score = s; }
+	uint32_t best_score() { return this->max_score; }
+	void set_best_score( uint32_t s) { this->max_score = s; }
+};
+
+template <>
+class NodeScores<false>
+{
+protected:
+	uint32_t own_score() { return 0; }
+	void set_own_score( uint32_t) {}
+	uint32_t best_score() { return 0; }
+	void set_best_score( uint32_t) {}
+};
+
+}
+
+#endif
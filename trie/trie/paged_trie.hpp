@@ -0,0 +1,548 @@
+#ifndef TRIE_PAGED_TRIE_H_
+#define TRIE_PAGED_TRIE_H_
+
+#include <string>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <type_traits>
+
+#include "trie/buffer_pool.hpp"
+#include "trie/exceptions.hpp"
+#include "trie/string.hpp"
+
+namespace trie
+{
+
+/* counters of a PagedTrie */
+struct PagedTrieStats
+{
+	uint64_t entry_count;
+	uint64_t page_count;		// pages of the file, including the header page
+	uint64_t cached_pages;		// pages kept in memory by the buffer pool
+	uint64_t garbage_bytes;		// bytes of the file that keep translations of deleted words
+	BufferPoolStats pool;
+};
+
+/* Trie of (word -> translation) pairs that lives in a file, for dictionaries that don't fit in memory
+	the file is a series of fixed-size pages, only the pages in the buffer pool (memory_budget bytes) are kept in memory
+	changed pages are written back one by one, when they are evicted or flushed, the file is never rewritten as a whole
+	(any function that has to write a page back throws ErrorWritingDictionaryException if the page can't be written)
+
+	nodes have a fixed size and keep their children as a list of siblings in the order of their characters,
+	so a node never moves or grows, and a new node is placed in the page of the nodes added right before it
+	(words added in lexicographic order keep their sub-tries in neighbouring pages)
+	translations are series of characters ending with end_of_string, same as Trie<character_t>, kept in separate pages
+	space of deleted nodes is reused, space of deleted translations is not (see PagedTrieStats::garbage_bytes)
+
+	same limits as Trie: words are shorter than 2^8 - 2 characters, translations shorter than 2^16 - 2 characters */
+template <class character_t>
+class PagedTrie
+{
+private:
+	/* a node of the file, positions are offsets of the file, 0 means none (page 0 keeps the header) */
+	struct paged_node
+	{
+		uint64_t first_child;
+		uint64_t next_sibling;		// also links the list of free nodes
+		uint64_t translation;		// position of [length (4 bytes)][characters, without end_of_string]
+		character_t character;
+	};
+
+	/* page 0 of the file */
+	struct file_header
+	{
+		uint64_t mark;
+		uint32_t page_size;
+		uint32_t character_size;
+		uint64_t entry_count;
+		uint64_t page_count;
+		uint64_t root;				// node of the empty word
+		uint64_t free_nodes;		// list of deleted nodes, reused before new ones
+		uint64_t node_tail;			// position of the next new node in the last page of nodes (0 if a new page is needed)
+		uint64_t translation_tail;	// same, for translations
+		uint64_t garbage_bytes;
+	};
+
+	static const uint64_t FILE_MARK = 0x45495254444547AAULL;
+
+	const character_t end_of_string = 0;
+
+	std::string dictionary_name;
+	FILE* file;
+	BufferPool* pool;
+	file_header header;
+
+	paged_node read_node( uint64_t position);
+	void write_node( uint64_t position, const paged_node& node);
+	uint64_t read_position( uint64_t position);
+	void write_position( uint64_t position, uint64_t value);
+
+	/* return a position for a new node (translation of size bytes) */
+	uint64_t allocate_node();
+	uint64_t allocate_translation( uint64_t size);
+
+	/* return the child of node for character (0 if there is none)
+		link is set to the position of the field that points (or would point) to that child,
+		first_child of node or next_sibling of a smaller sibling */
+	uint64_t find_child( uint64_t node, character_t character, uint64_t& link);
+
+	/* return the node of a word, 0 if it is not saved */
+	uint64_t find_node( const character_t* word, uint32_t word_length);
+
+	/* add the words of a sub-trie (current_word is the word of node) in toReturn until it has count words */
+	void prefix_words( uint64_t node, std::vector<character_t>& current_word, std::vector< std::vector<character_t> >& toReturn, uint64_t count);
+
+public:
+	/* open the paged dictionary file given as argument, or create it if it doesn't exist
+		memory_budget is the memory of the buffer pool in bytes (at least one page), page_size is used only for new files (at least 512 bytes)
+		throw ErrorOpeningDictionaryException if the file can't be opened or created
+		throw ErrorReadingDictionaryException if the file is not a paged dictionary, keeps characters of a different size or pages smaller than 512 bytes
+		throw ErrorWritingDictionaryException if the header of a new file can't be written */
+	PagedTrie( std::string dictionary_name, uint64_t memory_budget, uint32_t page_size = 4096, character_t eos = 0);
+
+	/* write all changed pages back in the file, changes that can't be written are lost (call flush to know) */
+	~PagedTrie();
+
+	/* a PagedTrie owns its file and its buffer pool, it can't be copied */
+	PagedTrie( const PagedTrie&) = delete;
+	PagedTrie& operator=( const PagedTrie&) = delete;
+
+	/* same functions as Trie<character_t>, see trie.hpp */
+	std::vector<character_t> search_word( const character_t* word);
+	std::vector<character_t> search_word( const character_t* word, uint32_t word_length);
+	std::vector<character_t> search_word( const std::vector<character_t> word);
+
+	bool add_word( const character_t* word, const character_t* translation);
+	bool add_word( const character_t* word, uint32_t word_length, const character_t* translation);
+	bool add_word( const std::vector<character_t> word, const std::vector<character_t> translation);
+
+	bool delete_word( const character_t* word);
+	bool delete_word( const character_t* word, uint32_t word_length);
+	bool delete_word( const std::vector<character_t> word);
+
+	std::vector< std::vector<character_t> > get_prefix_words( const character_t* word, int64_t n);
+	std::vector< std::vector<character_t> > get_prefix_words( const character_t* word, uint32_t word_length, int64_t n);
+	std::vector< std::vector<character_t> > get_prefix_words( const std::vector<character_t> word, int64_t n);
+
+	bool is_empty();
+	uint64_t get_entry_count();
+
+	/* write the header and all changed pages in the file, the file keeps all changes until now after flush returns
+		throw ErrorWritingDictionaryException if a page can't be written, the pages that weren't written stay in memory */
+	void flush();
+
+	PagedTrieStats get_stats();
+};
+
+template <class character_t>
+PagedTrie<character_t>::PagedTrie( std::string dictionary_name, uint64_t memory_budget, uint32_t page_size, character_t eos) : end_of_string(eos)
+{
+	if ( !std::is_same<character_t, uint8_t>::value && !std::is_same<character_t, uint16_t>::value && !std::is_same<character_t, uint32_t>::value )
+		throw ErrorCreatingTrieException();
+
+	this->dictionary_name = dictionary_name;
+
+	this->file = fopen( this->dictionary_name.c_str(), "r+b");
+	if (this->file != NULL)
+	{
+		if ( (fread( &this->header, sizeof(file_header), 1, this->file) != 1) || (this->header.mark != FILE_MARK) )
+		{
+			fclose( this->file );
+			throw ErrorReadingDictionaryException( this->dictionary_name, "Not a paged dictionary file");
+		}
+		if (this->header.character_size != sizeof(character_t))
+		{
+			fclose( this->file );
+			throw ErrorReadingDictionaryException( this->dictionary_name, "Conflicting Trie and File types");
+		}
+		if (this->header.page_size < 512)
+		{
+			fclose( this->file );
+			throw ErrorReadingDictionaryException( this->dictionary_name, "Broken page size");
+		}
+
+		this->pool = new BufferPool( this->dictionary_name, this->file, this->header.page_size, memory_budget / this->header.page_size, this->header.page_count);
+		return;
+	}
+
+	this->file = fopen( this->dictionary_name.c_str(), "w+b");
+	if (this->file == NULL)
+		throw ErrorOpeningDictionaryException(this->dictionary_name);
+
+	// header page, then the root in the first page of nodes
+	this->header = file_header();
+	this->header.mark = FILE_MARK;
+	this->header.page_size = std::max( page_size, (uint32_t) 512);
+	this->header.character_size = sizeof(character_t);
+	this->header.page_count = 1;
+
+	this->pool = new BufferPool( this->dictionary_name, this->file, this->header.page_size, memory_budget / this->header.page_size, this->header.page_count);
+
+	try
+	{
+		this->header.root = this->allocate_node();
+		this->write_node( this->header.root, paged_node() );
+		this->flush();
+	}
+	catch (ErrorWritingDictionaryException&)
+	{
+		delete this->pool;
+		fclose( this->file );
+		throw;
+	}
+}
+
+template <class character_t>
+PagedTrie<character_t>::~PagedTrie()
+{
+	// a destructor can't throw
+	try
+	{
+		this->flush();
+	}
+	catch (ErrorWritingDictionaryException&)
+	{
+	}
+	delete this->pool;
+	fclose( this->file );
+}
+
+template <class character_t>
+typename PagedTrie<character_t>::paged_node PagedTrie<character_t>::read_node( uint64_t position)
+{
+	paged_node toReturn;
+	this->pool->read( position, &toReturn, sizeof(paged_node));
+	return toReturn;
+}
+
+template <class character_t>
+void PagedTrie<character_t>::write_node( uint64_t position, const paged_node& node)
+{
+	this->pool->write( position, &node, sizeof(paged_node));
+}
+
+template <class character_t>
+uint64_t PagedTrie<character_t>::read_position( uint64_t position)
+{
+	uint64_t toReturn;
+	this->pool->read( position, &toReturn, sizeof(uint64_t));
+	return toReturn;
+}
+
+template <class character_t>
+void PagedTrie<character_t>::write_position( uint64_t position, uint64_t value)
+{
+	this->pool->write( position, &value, sizeof(uint64_t));
+}
+
+template <class character_t>
+uint64_t PagedTrie<character_t>::allocate_node()
+{
+	uint64_t toReturn;
+
+	if (this->header.free_nodes != 0)
+	{
+		toReturn = this->header.free_nodes;
+		this->header.free_nodes = this->read_node( toReturn ).next_sibling;
+		return toReturn;
+	}
+
+	// nodes never cross pages, a tail at the end of its page belongs to the next page, which is not a page of nodes
+	uint64_t page_size = this->header.page_size;
+	uint64_t free_bytes = (this->header.node_tail == 0) ? 0 : (page_size - this->header.node_tail % page_size) % page_size;
+	if (free_bytes < sizeof(paged_node))
+		this->header.node_tail = this->pool->allocate( 1 ) * page_size;
+
+	toReturn = this->header.node_tail;
+	this->header.node_tail += sizeof(paged_node);
+	this->header.page_count = this->pool->get_page_count();
+
+	return toReturn;
+}
+
+template <class character_t>
+uint64_t PagedTrie<character_t>::allocate_translation( uint64_t size)
+{
+	// a translation fits in the rest of the last page, or starts on new pages (as many as it needs, next to each other)
+	uint64_t page_size = this->header.page_size;
+	uint64_t free_bytes = (this->header.translation_tail == 0) ? 0 : (page_size - this->header.translation_tail % page_size) % page_size;
+	if (free_bytes < size)
+		this->header.translation_tail = this->pool->allocate( (size + page_size - 1) / page_size ) * page_size;
+
+	uint64_t toReturn = this->header.translation_tail;
+	this->header.translation_tail += size;
+	this->header.page_count = this->pool->get_page_count();
+
+	return toReturn;
+}
+
+template <class character_t>
+uint64_t PagedTrie<character_t>::find_child( uint64_t node, character_t character, uint64_t& link)
+{
+	link = node + offsetof( paged_node, first_child );
+	uint64_t child = this->read_position( link );
+
+	// siblings are in the order of their characters
+	while (child != 0)
+	{
+		paged_node current = this->read_node( child );
+		if (current.character == character)
+			return child;
+		if (current.character > character)
+			return 0;
+
+		link = child + offsetof( paged_node, next_sibling );
+		child = current.next_sibling;
+	}
+
+	return 0;
+}
+
+template <class character_t>
+uint64_t PagedTrie<character_t>::find_node( const character_t* word, uint32_t word_length)
+{
+	uint64_t current = this->header.root;
+	uint64_t link;
+	for (uint32_t i=0; (i < word_length) && (current != 0); i++)
+		current = this->find_child( current, word[i], link);
+
+	return current;
+}
+
+template <class character_t>
+std::vector<character_t> PagedTrie<character_t>::search_word( const character_t* word)
+{
+	return this->search_word( word, strlen( word, this->end_of_string) );
+}
+
+template <class character_t>
+std::vector<character_t> PagedTrie<character_t>::search_word( const character_t* word, uint32_t word_length)
+{
+	std::vector<character_t> toReturn;
+
+	uint64_t node = this->find_node( word, word_length);
+	if (node == 0)
+		return toReturn;
+
+	uint64_t translation = this->read_node( node ).translation;
+	if (translation == 0)
+		return toReturn;
+
+	uint32_t translation_length;
+	this->pool->read( translation, &translation_length, sizeof(uint32_t));
+	toReturn.resize( translation_length + 1 );
+	this->pool->read( translation + sizeof(uint32_t), toReturn.data(), (uint64_t) translation_length * sizeof(character_t));
+	toReturn[translation_length] = this->end_of_string;
+
+	return toReturn;
+}
+
+template <class character_t>
+std::vector<character_t> PagedTrie<character_t>::search_word( const std::vector<character_t> word)
+{
+	return this->search_word( word.data() );
+}
+
+template <class character_t>
+bool PagedTrie<character_t>::add_word( const character_t* word, const character_t* translation)
+{
+	return this->add_word( word, strlen( word, this->end_of_string), translation );
+}
+
+template <class character_t>
+bool PagedTrie<character_t>::add_word( const character_t* word, uint32_t word_length, const character_t* translation)
+{
+	uint32_t translation_length = strlen( translation, this->end_of_string);
+	if ( (word_length >= (uint32_t) (std::numeric_limits<uint8_t>::max()-1)) ||
+		 (translation_length >= (uint32_t) (std::numeric_limits<uint16_t>::max()-1)) ||
+		 (this->header.entry_count == std::numeric_limits<uint64_t>::max()) )
+		return false;
+
+	// read existing nodes until the unsaved part of the word, then add a node for every character left
+	uint64_t current = this->header.root;
+	uint64_t link;
+	for (uint32_t i=0; i < word_length; i++)
+	{
+		uint64_t child = this->find_child( current, word[i], link);
+		if (child == 0)
+		{
+			paged_node node = paged_node();
+			node.character = word[i];
+			node.next_sibling = this->read_position( link );
+
+			child = this->allocate_node();
+			this->write_node( child, node);
+			this->write_position( link, child);
+		}
+		current = child;
+	}
+
+	paged_node node = this->read_node( current );
+	if (node.translation != 0)
+		return false;
+
+	uint64_t size = sizeof(uint32_t) + (uint64_t) translation_length * sizeof(character_t);
+	node.translation = this->allocate_translation( size );
+	this->pool->write( node.translation, &translation_length, sizeof(uint32_t));
+	this->pool->write( node.translation + sizeof(uint32_t), translation, (uint64_t) translation_length * sizeof(character_t));
+	this->write_node( current, node);
+
+	this->header.entry_count++;
+
+	return true;
+}
+
+template <class character_t>
+bool PagedTrie<character_t>::add_word( const std::vector<character_t> word, const std::vector<character_t> translation)
+{
+	return this->add_word( word.data(), translation.data() );
+}
+
+template <class character_t>
+bool PagedTrie<character_t>::delete_word( const character_t* word)
+{
+	return this->delete_word( word, strlen( word, this->end_of_string) );
+}
+
+template <class character_t>
+bool PagedTrie<character_t>::delete_word( const character_t* word, uint32_t word_length)
+{
+	if (word_length >= (uint32_t) (std::numeric_limits<uint8_t>::max()-1))
+		return false;
+
+	// nodes of the path, with the fields that point to them
+	uint64_t delete_path[ std::numeric_limits<uint8_t>::max() ];
+	uint64_t links[ std::numeric_limits<uint8_t>::max() ];
+
+	delete_path[0] = this->header.root;
+	for (uint32_t i=0; i < word_length; i++)
+	{
+		delete_path[i+1] = this->find_child( delete_path[i], word[i], links[i+1]);
+		if (delete_path[i+1] == 0)
+			return false;
+	}
+
+	paged_node node = this->read_node( delete_path[word_length] );
+	if (node.translation == 0)
+		return false;
+
+	uint32_t translation_length;
+	this->pool->read( node.translation, &translation_length, sizeof(uint32_t));
+	this->header.garbage_bytes += sizeof(uint32_t) + (uint64_t) translation_length * sizeof(character_t);
+
+	node.translation = 0;
+	this->write_node( delete_path[word_length], node);
+	this->header.entry_count--;
+
+	// unlink nodes left without children and translation, bottom-up (root is never deleted)
+	for (uint32_t i=word_length; i > 0; i--)
+	{
+		node = this->read_node( delete_path[i] );
+		if ( (node.first_child != 0) || (node.translation != 0) )
+			break;
+
+		this->write_position( links[i], node.next_sibling);
+
+		node.next_sibling = this->header.free_nodes;
+		this->write_node( delete_path[i], node);
+		this->header.free_nodes = delete_path[i];
+	}
+
+	return true;
+}
+
+template <class character_t>
+bool PagedTrie<character_t>::delete_word( const std::vector<character_t> word)
+{
+	return this->delete_word( word.data() );
+}
+
+template <class character_t>
+void PagedTrie<character_t>::prefix_words( uint64_t node, std::vector<character_t>& current_word, std::vector< std::vector<character_t> >& toReturn, uint64_t count)
+{
+	paged_node current = this->read_node( node );
+
+	if (current.translation != 0)
+	{
+		toReturn.push_back( current_word );
+		toReturn.back().push_back( this->end_of_string );
+	}
+
+	for (uint64_t child = current.first_child; (child != 0) && (toReturn.size() < count); )
+	{
+		paged_node child_node = this->read_node( child );
+
+		current_word.push_back( child_node.character );
+		this->prefix_words( child, current_word, toReturn, count);
+		current_word.pop_back();
+
+		child = child_node.next_sibling;
+	}
+}
+
+template <class character_t>
+std::vector< std::vector<character_t> > PagedTrie<character_t>::get_prefix_words( const character_t* word, int64_t n)
+{
+	return this->get_prefix_words( word, strlen( word, this->end_of_string), n );
+}
+
+template <class character_t>
+std::vector< std::vector<character_t> > PagedTrie<character_t>::get_prefix_words( const character_t* word, uint32_t word_length, int64_t n)
+{
+	std::vector< std::vector<character_t> > toReturn;
+
+	uint64_t node = this->find_node( word, word_length);
+	if ( (node == 0) || (n == 0) )
+		return toReturn;
+
+	std::vector<character_t> current_word( word, word + word_length );
+	this->prefix_words( node, current_word, toReturn, (n < 0) ? std::numeric_limits<uint64_t>::max() : (uint64_t) n);
+
+	return toReturn;
+}
+
+template <class character_t>
+std::vector< std::vector<character_t> > PagedTrie<character_t>::get_prefix_words( const std::vector<character_t> word, int64_t n)
+{
+	return this->get_prefix_words( word.data(), n );
+}
+
+template <class character_t>
+bool PagedTrie<character_t>::is_empty()
+{
+	return this->header.entry_count == 0;
+}
+
+template <class character_t>
+uint64_t PagedTrie<character_t>::get_entry_count()
+{
+	return this->header.entry_count;
+}
+
+template <class character_t>
+void PagedTrie<character_t>::flush()
+{
+	this->pool->write( 0, &this->header, sizeof(file_header));
+	this->pool->flush();
+}
+
+template <class character_t>
+PagedTrieStats PagedTrie<character_t>::get_stats()
+{
+	PagedTrieStats toReturn;
+	toReturn.entry_count = this->header.entry_count;
+	toReturn.page_count = this->pool->get_page_count();
+	toReturn.cached_pages = this->pool->get_cached_count();
+	toReturn.garbage_bytes = this->header.garbage_bytes;
+	toReturn.pool = this->pool->get_stats();
+
+	return toReturn;
+}
+
+}
+
+#endif
@@ -0,0 +1,221 @@
+#ifndef TRIE_PATTERN_H_
+#define TRIE_PATTERN_H_
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+#include "trie/exceptions.hpp"
+
+namespace trie
+{
+
+/* glob-style pattern over the characters of a Trie (see Trie::for_each_match)
+	?      : any single character
+	*      : any series of characters, including none
+	[abc]  : one of the characters a, b, c, [a-z] for a range, [!abc] or [^abc] for any character except them
+	\c     : character c as it is (e.g. \* or \?)
+	any other character matches itself
+	the whole word has to match the pattern
+
+	the pattern is read as an automaton, a set of states is the set of pattern positions that the characters read so far can reach
+	so every word (TrieNode) is visited at most once, no matter how many stars the pattern has */
+template <class character_t>
+class Pattern
+{
+public:
+	enum element_kind : uint8_t
+	{
+		LITERAL,
+		ANY,
+		STAR,
+		CLASS
+	};
+
+	/* set of pattern positions, in increasing order (position elements.size() means the whole pattern is matched) */
+	using states_t = std::vector<uint32_t>;
+
+private:
+	struct element
+	{
+		element_kind kind;
+		bool negated;			// classes only
+		character_t character;	// literals only
+		uint32_t ranges_begin;	// classes only, ranges [ranges_begin, ranges_end) of ranges
+		uint32_t ranges_end;
+	};
+
+	std::vector<element> elements;
+
+	/* inclusive ranges of characters of all classes */
+	std::vector< std::pair<character_t, character_t> > ranges;
+
+	/* add position to states, with all positions after it that a star lets you skip to */
+	void add_state( states_t& states, uint32_t position);
+
+	bool class_contains( const element& e, character_t c);
+
+public:
+	/* throw InvalidPatternException for a class without ] or a \ at the end of the pattern */
+	Pattern( const character_t* pattern, uint32_t pattern_length);
+
+	/* states before the first character */
+	void start( states_t& states);
+
+	/* states after reading character c from states, next is empty if no word that continues with c can match */
+	void step( const states_t& states, character_t c, states_t& next);
+
+	/* return true if the characters read so far are a word that matches the pattern */
+	bool accepts( const states_t& states);
+
+	/* if every state can only continue with a literal, set literals to these characters in increasing order and return true
+		so that only these children need to be visited */
+	bool only_literals( const states_t& states, std::vector<character_t>& literals);
+};
+
+template <class character_t>
+Pattern<character_t>::Pattern( const character_t* pattern, uint32_t pattern_length)
+{
+	uint32_t i = 0;
+	while (i < pattern_length)
+	{
+		element e = { LITERAL, false, pattern[i], 0, 0 };
+
+		if (pattern[i] == (character_t) '?')
+		{
+			e.kind = ANY;
+			i++;
+		}
+		else if (pattern[i] == (character_t) '*')
+		{
+			i++;
+
+			// a series of stars is the same as a single one
+			if ( !this->elements.empty() && this->elements.back().kind == STAR )
+				continue;
+			e.kind = STAR;
+		}
+		else if (pattern[i] == (character_t) '\\')
+		{
+			if (i + 1 == pattern_length)
+				throw InvalidPatternException( "escape character at the end of the pattern" );
+			e.character = pattern[i+1];
+			i += 2;
+		}
+		else if (pattern[i] == (character_t) '[')
+		{
+			e.kind = CLASS;
+			i++;
+			if ( (i < pattern_length) && (pattern[i] == (character_t) '!' || pattern[i] == (character_t) '^') )
+			{
+				e.negated = true;
+				i++;
+			}
+
+			// a ] right after the [ (or the negation) is a character of the class
+			e.ranges_begin = this->ranges.size();
+			bool first = true;
+			while ( (i < pattern_length) && (first || pattern[i] != (character_t) ']') )
+			{
+				character_t low = pattern[i];
+				character_t high = low;
+				if ( (i + 2 < pattern_length) && (pattern[i+1] == (character_t) '-') && (pattern[i+2] != (character_t) ']') )
+				{
+					high = pattern[i+2];
+					i += 2;
+				}
+				i++;
+
+				if (low <= high)
+					this->ranges.push_back( std::make_pair( low, high) );
+				first = false;
+			}
+
+			if (i == pattern_length)
+				throw InvalidPatternException( "character class without ]" );
+			e.ranges_end = this->ranges.size();
+			i++;
+		}
+		else
+		{
+			i++;
+		}
+
+		this->elements.push_back( e );
+	}
+}
+
+template <class character_t>
+void Pattern<character_t>::add_state( states_t& states, uint32_t position)
+{
+	states.push_back( position );
+	while ( (position < this->elements.size()) && (this->elements[position].kind == STAR) )
+		states.push_back( ++position );
+}
+
+template <class character_t>
+bool Pattern<character_t>::class_contains( const element& e, character_t c)
+{
+	bool found = false;
+	for (uint32_t i = e.ranges_begin; (i < e.ranges_end) && !found; i++)
+		found = (this->ranges[i].first <= c) && (c <= this->ranges[i].second);
+
+	return found != e.negated;
+}
+
+template <class character_t>
+void Pattern<character_t>::start( states_t& states)
+{
+	states.clear();
+	this->add_state( states, 0);
+}
+
+template <class character_t>
+void Pattern<character_t>::step( const states_t& states, character_t c, states_t& next)
+{
+	next.clear();
+	for (uint32_t position : states)
+	{
+		if (position == this->elements.size())
+			continue;
+
+		const element& e = this->elements[position];
+		if (e.kind == STAR)
+			this->add_state( next, position);
+		else if ( (e.kind == ANY) || (e.kind == LITERAL && e.character == c) || (e.kind == CLASS && this->class_contains( e, c)) )
+			this->add_state( next, position + 1);
+	}
+
+	// stars can add the same positions more than once, and out of order
+	std::sort( next.begin(), next.end() );
+	next.erase( std::unique( next.begin(), next.end() ), next.end() );
+}
+
+template <class character_t>
+bool Pattern<character_t>::accepts( const states_t& states)
+{
+	return !states.empty() && (states.back() == this->elements.size());
+}
+
+template <class character_t>
+bool Pattern<character_t>::only_literals( const states_t& states, std::vector<character_t>& literals)
+{
+	literals.clear();
+	for (uint32_t position : states)
+	{
+		if (position == this->elements.size())
+			continue;
+		if (this->elements[position].kind != LITERAL)
+			return false;
+		literals.push_back( this->elements[position].character );
+	}
+
+	std::sort( literals.begin(), literals.end() );
+	literals.erase( std::unique( literals.begin(), literals.end() ), literals.end() );
+
+	return true;
+}
+
+}
+
+#endif
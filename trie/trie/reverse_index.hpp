@@ -0,0 +1,303 @@
+#ifndef TRIE_REVERSE_INDEX_H_
+#define TRIE_REVERSE_INDEX_H_
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "trie/word_filter.hpp"
+
+namespace trie
+{
+
+/* index of translations to the words saved with them (see Trie::enable_reverse_index)
+	a hash table with open addressing and linear probing (same as WordIndex), every slot keeps a translation of any length
+	with its postings, the words of the translation in lexicographic order, both without their end_of_string
+	a slot without words is empty, deleted translations leave no tombstones (later slots are shifted back)
+	the table has at least twice as many slots as translations, and at most 8 times as many (or 16 slots) */
+template <class character_t>
+class ReverseIndex
+{
+private:
+	static const uint64_t MIN_SLOTS = 16;
+
+	struct slot
+	{
+		uint64_t hash;
+		std::vector<character_t> translation;
+		std::vector< std::vector<character_t> > words;
+	};
+
+	std::vector<slot> slots;
+	uint64_t slot_mask;
+	uint64_t translation_count;
+	uint64_t word_count;
+
+	/* slot of translation, or the empty slot where it would go */
+	uint64_t position( uint64_t hash, const character_t* translation, uint32_t translation_length);
+
+	/* move all translations in a table of slot_count slots (a power of 2) */
+	void resize( uint64_t slot_count);
+
+public:
+	ReverseIndex();
+
+	/* return the words of translation, NULL if no word is saved with it */
+	const std::vector< std::vector<character_t> >* find( const character_t* translation, uint32_t translation_length);
+
+	/* add word to the words of translation */
+	void insert( const character_t* translation, uint32_t translation_length, const character_t* word, uint32_t word_length);
+
+	/* delete word from the words of translation, return false if it is not one of them */
+	bool erase( const character_t* translation, uint32_t translation_length, const character_t* word, uint32_t word_length);
+
+	uint64_t get_word_count();
+
+	/* memory of the index */
+	uint64_t get_bytes();
+
+	/* [number of slots (8 bytes)][translations (8 bytes)], then for every translation
+		[its slot (8 bytes)][hash (8 bytes)][length (4 bytes)][translation][words (4 bytes)] and [length (1 byte)][word] for every word
+		read puts every translation in its slot as it is, nothing is hashed or sorted again
+		read returns false for a broken index, or an index that needs more than the size bytes that are left for it in the file */
+	void write( FILE* file);
+	bool read( FILE* file, uint64_t size);
+};
+
+template <class character_t>
+ReverseIndex<character_t>::ReverseIndex()
+{
+	this->slots.resize( MIN_SLOTS );
+	this->slot_mask = MIN_SLOTS - 1;
+	this->translation_count = 0;
+	this->word_count = 0;
+}
+
+template <class character_t>
+uint64_t ReverseIndex<character_t>::position( uint64_t hash, const character_t* translation, uint32_t translation_length)
+{
+	uint64_t toReturn = hash & this->slot_mask;
+	while ( !this->slots[toReturn].words.empty() &&
+			((this->slots[toReturn].hash != hash) || (this->slots[toReturn].translation.size() != translation_length) ||
+			 !std::equal( translation, translation + translation_length, this->slots[toReturn].translation.begin())) )
+		toReturn = (toReturn + 1) & this->slot_mask;
+
+	return toReturn;
+}
+
+template <class character_t>
+void ReverseIndex<character_t>::resize( uint64_t slot_count)
+{
+	std::vector<slot> old_slots( slot_count );
+	old_slots.swap( this->slots );
+	this->slot_mask = slot_count - 1;
+
+	for (slot& s : old_slots)
+	{
+		if (s.words.empty())
+			continue;
+
+		uint64_t i = s.hash & this->slot_mask;
+		while (!this->slots[i].words.empty())
+			i = (i + 1) & this->slot_mask;
+		this->slots[i] = std::move( s );
+	}
+}
+
+template <class character_t>
+const std::vector< std::vector<character_t> >* ReverseIndex<character_t>::find( const character_t* translation, uint32_t translation_length)
+{
+	const slot& s = this->slots[ this->position( word_hash( translation, translation_length), translation, translation_length) ];
+	return s.words.empty() ? NULL : &s.words;
+}
+
+template <class character_t>
+void ReverseIndex<character_t>::insert( const character_t* translation, uint32_t translation_length, const character_t* word, uint32_t word_length)
+{
+	uint64_t hash = word_hash( translation, translation_length);
+	uint64_t i = this->position( hash, translation, translation_length);
+	if (this->slots[i].words.empty())
+	{
+		// at most half of the slots are used
+		if (2 * (this->translation_count + 1) > this->slots.size())
+		{
+			this->resize( 2 * this->slots.size() );
+			i = this->position( hash, translation, translation_length);
+		}
+
+		this->slots[i].hash = hash;
+		this->slots[i].translation.assign( translation, translation + translation_length );
+		this->translation_count++;
+	}
+
+	// words usually come in lexicographic order (e.g. when the index is built), and then they are appended
+	std::vector< std::vector<character_t> >& words = this->slots[i].words;
+	std::vector<character_t> key( word, word + word_length );
+	words.insert( std::lower_bound( words.begin(), words.end(), key), std::move( key ) );
+	this->word_count++;
+}
+
+template <class character_t>
+bool ReverseIndex<character_t>::erase( const character_t* translation, uint32_t translation_length, const character_t* word, uint32_t word_length)
+{
+	uint64_t i = this->position( word_hash( translation, translation_length), translation, translation_length);
+	std::vector< std::vector<character_t> >& words = this->slots[i].words;
+
+	std::vector<character_t> key( word, word + word_length );
+	auto found = std::lower_bound( words.begin(), words.end(), key);
+	if ( (found == words.end()) || (*found != key) )
+		return false;
+
+	words.erase( found );
+	this->word_count--;
+	if (!words.empty())
+		return true;
+
+	this->translation_count--;
+	this->slots[i].translation = std::vector<character_t>();
+	words = std::vector< std::vector<character_t> >();
+
+	// shift back the following slots of the run that can't be found anymore after an empty slot at i (same as WordIndex)
+	uint64_t j = i;
+	while (true)
+	{
+		j = (j + 1) & this->slot_mask;
+		if (this->slots[j].words.empty())
+			break;
+
+		uint64_t home = this->slots[j].hash & this->slot_mask;
+		if ( (i <= j) ? ((home <= i) || (home > j)) : ((home <= i) && (home > j)) )
+		{
+			std::swap( this->slots[i], this->slots[j] );
+			i = j;
+		}
+	}
+
+	// tables of many deleted translations get smaller
+	if ( (this->slots.size() > MIN_SLOTS) && (8 * this->translation_count < this->slots.size()) )
+		this->resize( this->slots.size() / 2 );
+
+	return true;
+}
+
+template <class character_t>
+uint64_t ReverseIndex<character_t>::get_word_count()
+{
+	return this->word_count;
+}
+
+template <class character_t>
+uint64_t ReverseIndex<character_t>::get_bytes()
+{
+	uint64_t toReturn = sizeof(ReverseIndex) + this->slots.capacity() * sizeof(slot);
+	for (const slot& s : this->slots)
+	{
+		toReturn += s.translation.capacity() * sizeof(character_t) + s.words.capacity() * sizeof(std::vector<character_t>);
+		for (const std::vector<character_t>& word : s.words)
+			toReturn += word.capacity() * sizeof(character_t);
+	}
+
+	return toReturn;
+}
+
+template <class character_t>
+void ReverseIndex<character_t>::write( FILE* file)
+{
+	uint64_t slot_count = this->slots.size();
+	fwrite( &slot_count, sizeof(uint64_t), 1, file);
+	fwrite( &this->translation_count, sizeof(uint64_t), 1, file);
+
+	for (uint64_t i=0; i < slot_count; i++)
+	{
+		const slot& s = this->slots[i];
+		if (s.words.empty())
+			continue;
+
+		uint32_t translation_length = (uint32_t) s.translation.size();
+		uint32_t words = (uint32_t) s.words.size();
+		fwrite( &i, sizeof(uint64_t), 1, file);
+		fwrite( &s.hash, sizeof(uint64_t), 1, file);
+		fwrite( &translation_length, sizeof(uint32_t), 1, file);
+		fwrite( s.translation.data(), sizeof(character_t), translation_length, file);
+		fwrite( &words, sizeof(uint32_t), 1, file);
+		for (const std::vector<character_t>& word : s.words)
+		{
+			uint8_t word_length = (uint8_t) word.size();
+			fwrite( &word_length, sizeof(uint8_t), 1, file);
+			// the empty word has no characters (and maybe no data)
+			if (word_length > 0)
+				fwrite( word.data(), sizeof(character_t), word_length, file);
+		}
+	}
+}
+
+template <class character_t>
+bool ReverseIndex<character_t>::read( FILE* file, uint64_t size)
+{
+	// every read is checked against the bytes that are left, so nothing is allocated for broken sizes
+	auto take = [&]( uint64_t bytes)
+	{
+		if (bytes > size)
+			return false;
+		size -= bytes;
+		return true;
+	};
+
+	uint64_t slot_count, translation_count;
+	if ( !take( 2 * sizeof(uint64_t) ) || (fread( &slot_count, sizeof(uint64_t), 1, file) != 1) ||
+		 (fread( &translation_count, sizeof(uint64_t), 1, file) != 1) )
+		return false;
+
+	// a translation takes at least 24 bytes of the file, and the size of the table follows from the number of translations
+	uint64_t entry_bytes = 2 * sizeof(uint64_t) + 2 * sizeof(uint32_t);
+	if ( (translation_count > size / entry_bytes) || (slot_count < MIN_SLOTS) || ((slot_count & (slot_count - 1)) != 0) ||
+		 (2 * translation_count > slot_count) || ((slot_count > MIN_SLOTS) && (slot_count > 8 * translation_count)) )
+		return false;
+
+	this->slots.clear();
+	this->slots.resize( slot_count );
+	this->slot_mask = slot_count - 1;
+	this->translation_count = translation_count;
+	this->word_count = 0;
+
+	for (uint64_t t=0; t < translation_count; t++)
+	{
+		uint64_t i, hash;
+		uint32_t translation_length, words;
+		if ( !take( entry_bytes - sizeof(uint32_t) ) || (fread( &i, sizeof(uint64_t), 1, file) != 1) || (fread( &hash, sizeof(uint64_t), 1, file) != 1) ||
+			 (fread( &translation_length, sizeof(uint32_t), 1, file) != 1) || (i >= slot_count) || !this->slots[i].words.empty() )
+			return false;
+
+		if ( !take( (uint64_t) translation_length * sizeof(character_t) + sizeof(uint32_t) ) )
+			return false;
+
+		slot& s = this->slots[i];
+		s.hash = hash;
+		s.translation.resize( translation_length );
+		if ( (fread( s.translation.data(), sizeof(character_t), translation_length, file) != translation_length) ||
+			 (fread( &words, sizeof(uint32_t), 1, file) != 1) || (words == 0) || (words > size) )
+			return false;
+
+		s.words.resize( words );
+		for (std::vector<character_t>& word : s.words)
+		{
+			uint8_t word_length;
+			if ( !take( sizeof(uint8_t) ) || (fread( &word_length, sizeof(uint8_t), 1, file) != 1) ||
+				 !take( (uint64_t) word_length * sizeof(character_t) ) )
+				return false;
+
+			word.resize( word_length );
+			if (fread( word.data(), sizeof(character_t), word_length, file) != word_length)
+				return false;
+		}
+		this->word_count += words;
+	}
+
+	return true;
+}
+
+}
+
+#endif
@@ -0,0 +1,235 @@
+#ifndef TRIE_STATIC_TRIE_H_
+#define TRIE_STATIC_TRIE_H_
+
+#if __cplusplus < 201703L
+#error "static_trie.hpp needs C++17"
+#endif
+
+#include <cstddef>
+#include <string_view>
+#include <stdint.h>
+
+#include "trie/exceptions.hpp"
+
+namespace trie
+{
+
+/* a word of a StaticTrie with its value (e.g. the token of a keyword) */
+template <class character_t, class value_t>
+struct StaticEntry
+{
+	std::basic_string_view<character_t> word;
+	value_t value;
+};
+
+/* number of TrieNodes of a StaticTrie of entries (the distinct prefixes of the words, including the empty one) */
+template <class character_t, class value_t, std::size_t entry_count>
+constexpr std::size_t static_trie_nodes( const StaticEntry<character_t, value_t> (&entries)[entry_count])
+{
+	std::size_t toReturn = 1;
+	for (std::size_t i=0; i < entry_count; i++)
+	{
+		for (std::size_t length=1; length <= entries[i].word.size(); length++)
+		{
+			// count a prefix only for the first word that has it
+			bool seen = false;
+			for (std::size_t j=0; (j < i) && !seen; j++)
+				seen = (entries[j].word.size() >= length) && (entries[j].word.substr( 0, length) == entries[i].word.substr( 0, length));
+			if (!seen)
+				toReturn++;
+		}
+	}
+
+	return toReturn;
+}
+
+/* read-only Trie of a fixed table of words (e.g. keywords to tokens), built by the compiler from string literals
+		constexpr trie::StaticEntry<char, int> verbs[] = { {"GET", 1}, {"HEAD", 2}, {"POST", 3} };
+		constexpr trie::StaticTrie<char, int, trie::static_trie_nodes(verbs)> table( verbs );
+		static_assert( *table.search_word( "HEAD" ) == 2 );
+	so a table needs no memory of the heap and no work at startup
+	TrieNodes are kept in flat arrays in breadth-first order, the children of a TrieNode are next to each other
+	in the order of their characters, a lookup compares the characters of one array and follows an index per character
+	the same word given twice keeps its first value (same as Trie::add_word)
+	searches follow Trie's version for values that are not strings: they return a pointer to the value, NULL if the word is not saved */
+template <class character_t, class value_t, std::size_t node_count>
+class StaticTrie
+{
+private:
+	/* character of the edge to every TrieNode (the head has none), and the children of every TrieNode
+		children of node are first_child[node], ..., first_child[node] + child_count[node] - 1 */
+	character_t characters[node_count] = {};
+	uint32_t first_child[node_count] = {};
+	uint32_t child_count[node_count] = {};
+
+	bool has_value[node_count] = {};
+	value_t values[node_count] = {};
+
+	std::size_t entry_count = 0;
+
+	/* return the child of node for character, 0 (the head, never a child) if it doesn't exist */
+	constexpr uint32_t get_child( uint32_t node, character_t character) const;
+
+public:
+	/* throw StaticTrieSizeException (a compile-time error in constant expressions) if node_count is too small */
+	template <std::size_t count>
+	constexpr StaticTrie( const StaticEntry<character_t, value_t> (&entries)[count]);
+
+	constexpr const value_t* search_word( const character_t* word, uint32_t word_length) const;
+	constexpr const value_t* search_word( std::basic_string_view<character_t> word) const;
+
+	/* find the longest saved word that is a prefix of the key, set matched_length to its length (0 if there is none) */
+	constexpr const value_t* longest_prefix_match( const character_t* key, uint32_t key_length, uint32_t& matched_length) const;
+	constexpr const value_t* longest_prefix_match( std::basic_string_view<character_t> key, uint32_t& matched_length) const;
+
+	constexpr std::size_t get_entry_count() const;
+	constexpr std::size_t get_node_count() const;
+};
+
+template <class character_t, class value_t, std::size_t node_count>
+template <std::size_t count>
+constexpr StaticTrie<character_t, value_t, node_count>::StaticTrie( const StaticEntry<character_t, value_t> (&entries)[count])
+{
+	// build a Trie with first child / next sibling links first, siblings in the order of their characters (0 for no TrieNode)
+	character_t character[node_count] = {};
+	uint32_t child[node_count] = {};
+	uint32_t sibling[node_count] = {};
+	std::size_t entry[node_count] = {};	// index of the entry of a word + 1, 0 for no word
+	uint32_t used = 1;
+
+	for (std::size_t i=0; i < count; i++)
+	{
+		uint32_t node = 0;
+		for (character_t c : entries[i].word)
+		{
+			uint32_t previous = 0;
+			uint32_t next = child[node];
+			while ( (next != 0) && (character[next] < c) )
+			{
+				previous = next;
+				next = sibling[next];
+			}
+
+			if ( (next == 0) || (character[next] != c) )
+			{
+				if (used == node_count)
+					throw StaticTrieSizeException();
+
+				character[used] = c;
+				sibling[used] = next;
+				if (previous == 0)
+					child[node] = used;
+				else
+					sibling[previous] = used;
+				next = used++;
+			}
+
+			node = next;
+		}
+
+		if (entry[node] == 0)
+		{
+			entry[node] = i + 1;
+			this->entry_count++;
+		}
+	}
+
+	// then place the TrieNodes breadth-first, every TrieNode puts its children in the next free positions
+	uint32_t order[node_count] = {};
+	uint32_t placed = 1;
+	for (uint32_t i=0; i < used; i++)
+	{
+		uint32_t node = order[i];
+
+		this->first_child[i] = placed;
+		for (uint32_t c = child[node]; c != 0; c = sibling[c])
+		{
+			order[placed] = c;
+			this->characters[placed] = character[c];
+			this->child_count[i]++;
+			placed++;
+		}
+
+		if (entry[node] != 0)
+		{
+			this->has_value[i] = true;
+			this->values[i] = entries[ entry[node] - 1 ].value;
+		}
+	}
+}
+
+template <class character_t, class value_t, std::size_t node_count>
+constexpr uint32_t StaticTrie<character_t, value_t, node_count>::get_child( uint32_t node, character_t character) const
+{
+	uint32_t end = this->first_child[node] + this->child_count[node];
+	for (uint32_t i = this->first_child[node]; i < end; i++)
+		if (this->characters[i] == character)
+			return i;
+
+	return 0;
+}
+
+template <class character_t, class value_t, std::size_t node_count>
+constexpr const value_t* StaticTrie<character_t, value_t, node_count>::search_word( const character_t* word, uint32_t word_length) const
+{
+	uint32_t node = 0;
+	for (uint32_t i=0; i < word_length; i++)
+	{
+		node = this->get_child( node, word[i] );
+		if (node == 0)
+			return NULL;
+	}
+
+	return this->has_value[node] ? &this->values[node] : NULL;
+}
+
+template <class character_t, class value_t, std::size_t node_count>
+constexpr const value_t* StaticTrie<character_t, value_t, node_count>::search_word( std::basic_string_view<character_t> word) const
+{
+	return this->search_word( word.data(), (uint32_t) word.size() );
+}
+
+template <class character_t, class value_t, std::size_t node_count>
+constexpr const value_t* StaticTrie<character_t, value_t, node_count>::longest_prefix_match( const character_t* key, uint32_t key_length, uint32_t& matched_length) const
+{
+	const value_t* toReturn = this->has_value[0] ? &this->values[0] : NULL;
+	matched_length = 0;
+
+	uint32_t node = 0;
+	for (uint32_t i=0; i < key_length; i++)
+	{
+		node = this->get_child( node, key[i] );
+		if (node == 0)
+			break;
+
+		if (this->has_value[node])
+		{
+			toReturn = &this->values[node];
+			matched_length = i + 1;
+		}
+	}
+
+	return toReturn;
+}
+
+template <class character_t, class value_t, std::size_t node_count>
+constexpr const value_t* StaticTrie<character_t, value_t, node_count>::longest_prefix_match( std::basic_string_view<character_t> key, uint32_t& matched_length) const
+{
+	return this->longest_prefix_match( key.data(), (uint32_t) key.size(), matched_length );
+}
+
+template <class character_t, class value_t, std::size_t node_count>
+constexpr std::size_t StaticTrie<character_t, value_t, node_count>::get_entry_count() const
+{
+	return this->entry_count;
+}
+
+template <class character_t, class value_t, std::size_t node_count>
+constexpr std::size_t StaticTrie<character_t, value_t, node_count>::get_node_count() const
+{
+	return node_count;
+}
+
+}
+
+#endif
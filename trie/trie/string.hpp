@@ -3,6 +3,7 @@
 
 #include <string>
 #include <vector>
+#include <stdint.h>
 
 namespace trie
 {
@@ -11,7 +12,7 @@ namespace trie
 template <typename character_t>
 int strcmp(const character_t* s1, const character_t* s2, character_t end_of_string = 0)
 {
-	character_t current_index = 0;
+	uint32_t current_index = 0;
 
 	while (s1[current_index] == s2[current_index])
 	{
@@ -29,7 +30,7 @@ int strcmp(const character_t* s1, const character_t* s2, character_t end_of_stri
 		return 0;
 }
 template <typename character_t>
-int strcmp(const std::vector<character_t> s1, const std::vector<character_t> s2, character_t end_of_string = 0)
+int strcmp(const std::vector<character_t>& s1, const std::vector<character_t>& s2, character_t end_of_string = 0)
 {
 	return strcmp( s1.data(), s2.data(), end_of_string );
 }
@@ -39,9 +40,8 @@ template <typename character_t>
 uint32_t strlen(const character_t* array, character_t end_of_string = 0)
 {
 	uint32_t toReturn = 0;
-	character_t current_index = 0;
 
-	while (array[current_index++] != end_of_string)
+	while (array[toReturn] != end_of_string)
 	{
 		++toReturn;
 	}
@@ -49,7 +49,7 @@ uint32_t strlen(const character_t* array, character_t end_of_string = 0)
 	return toReturn;
 }
 template <typename character_t>
-uint32_t strlen(const std::vector<character_t> array, character_t end_of_string = 0)
+uint32_t strlen(const std::vector<character_t>& array, character_t end_of_string = 0)
 {
 	return strlen( array.data(), end_of_string );
 }
@@ -58,7 +58,7 @@ uint32_t strlen(const std::vector<character_t> array, character_t end_of_string
 template <typename character_t>
 character_t* strcpy(character_t* dst, const character_t* src, character_t end_of_string = 0)
 {
-	character_t current_index = 0;
+	uint32_t current_index = 0;
 
 	while (src[current_index] != end_of_string)
 	{
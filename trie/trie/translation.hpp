@@ -0,0 +1,246 @@
+#ifndef TRIE_TRANSLATION_H_
+#define TRIE_TRANSLATION_H_
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <type_traits>
+
+#include "trie/string.hpp"
+
+namespace trie
+{
+
+/* describes how the translation of a TrieNode is kept in memory and on disk
+	general case: trivially copyable values (ids, small structs) saved inline in the TrieNode,
+	so that no encoding/decoding to strings is needed on every access */
+template <class character_t, class value_t>
+class TranslationTraits
+{
+	static_assert( std::is_trivially_copyable<value_t>::value, "Trie values need to be trivially copyable" );
+	static_assert( sizeof(value_t) < std::numeric_limits<uint16_t>::max(), "Trie values need to fit in a dictionary file translation" );
+
+public:
+	/* value kept in the TrieNode, with a flag to mark if it exists at all */
+	struct storage_type
+	{
+		value_t value;
+		bool exists;
+	};
+
+	/* type received by add_word, type received by the vector overloads, type returned by search_word */
+	using argument_type = const value_t&;
+	using container_type = value_t;
+	using result_type = const value_t*;
+
+	static void init( storage_type& s)
+	{
+		s.exists = false;
+	}
+
+	static void clear( storage_type& s)
+	{
+		s.exists = false;
+	}
+
+	static bool exists( const storage_type& s)
+	{
+		return s.exists;
+	}
+
+	static void set( storage_type& s, argument_type t, uint32_t, character_t)
+	{
+		s.value = t;
+		s.exists = true;
+	}
+
+	/* values always have the same size, no need to read them */
+	static uint32_t measure( argument_type, character_t)
+	{
+		return sizeof(value_t);
+	}
+
+	static bool is_valid( uint32_t)
+	{
+		return true;
+	}
+
+	/* values are kept inline, in the TrieNode */
+	static uint64_t heap_size( const storage_type&, character_t)
+	{
+		return 0;
+	}
+
+	/* values are compared with the operator== of value_t (only diff needs it)
+		bytes can't be compared, padding bytes of equal values can differ */
+	static bool equal( const storage_type& a, const storage_type& b, character_t)
+	{
+		return a.value == b.value;
+	}
+
+	static argument_type to_argument( const container_type& c)
+	{
+		return c;
+	}
+
+	/* access the value saved in the TrieNode without copying it */
+	static argument_type view( const storage_type& s)
+	{
+		return s.value;
+	}
+
+	/* return a pointer to the value saved in the TrieNode, or NULL if there is no value */
+	static result_type to_result( const storage_type& s, character_t)
+	{
+		return (s.exists) ? &s.value : NULL;
+	}
+
+	static result_type empty_result()
+	{
+		return NULL;
+	}
+
+	/* bytes written by write */
+	static uint64_t file_size( const storage_type&, character_t)
+	{
+		return sizeof(uint16_t) + sizeof(value_t);
+	}
+
+	/* same framing as string translations (size, data), size is always sizeof(value_t) */
+	static void write( const storage_type& s, FILE* file, character_t)
+	{
+		uint16_t translation_size = sizeof(value_t);
+		fwrite( &translation_size, sizeof(uint16_t), 1, file);
+		fwrite( &s.value, sizeof(value_t), 1, file);
+	}
+
+	/* return false if the file keeps translations of a different size */
+	static bool read( FILE* file, container_type& c, character_t)
+	{
+		uint16_t translation_size;
+		if (fread( &translation_size, sizeof(uint16_t), 1, file) != 1 || translation_size != sizeof(value_t))
+			return false;
+
+		return fread( &c, sizeof(value_t), 1, file) == 1;
+	}
+};
+
+/* specialization for series of characters ending with end_of_string (the classic word -> translation case) */
+template <class character_t>
+class TranslationTraits< character_t, std::vector<character_t> >
+{
+public:
+	/* variable size, NULL or translation_size*sizeof(character_size)+sizeof(character_size) bytes */
+	using storage_type = character_t*;
+
+	using argument_type = const character_t*;
+	using container_type = std::vector<character_t>;
+	using result_type = std::vector<character_t>;
+
+	static void init( storage_type& s)
+	{
+		s = NULL;
+	}
+
+	static void clear( storage_type& s)
+	{
+		delete[] s;
+		s = NULL;
+	}
+
+	static bool exists( const storage_type& s)
+	{
+		return s != NULL;
+	}
+
+	/* length of the translation is already known (see measure), copy it in a single pass */
+	static void set( storage_type& s, argument_type t, uint32_t length, character_t end_of_string)
+	{
+		delete[] s;
+
+		s = new character_t[length + 1];
+		std::copy( t, t + length, s);
+		s[length] = end_of_string;
+	}
+
+	static uint32_t measure( argument_type t, character_t end_of_string)
+	{
+		return strlen( t, end_of_string);
+	}
+
+	static bool is_valid( uint32_t length)
+	{
+		return length < (uint32_t) (std::numeric_limits<uint16_t>::max()-1);
+	}
+
+	static bool equal( const storage_type& a, const storage_type& b, character_t end_of_string)
+	{
+		return strcmp( a, b, end_of_string) == 0;
+	}
+
+	/* bytes of the series of characters, including end_of_string */
+	static uint64_t heap_size( const storage_type& s, character_t end_of_string)
+	{
+		return (s == NULL) ? 0 : ((uint64_t) strlen( s, end_of_string) + 1) * sizeof(character_t);
+	}
+
+	static argument_type to_argument( const container_type& c)
+	{
+		return c.data();
+	}
+
+	/* access the translation saved in the TrieNode without copying it */
+	static argument_type view( const storage_type& s)
+	{
+		return s;
+	}
+
+	/* return a copy of the translation, including the end_of_string */
+	static result_type to_result( const storage_type& s, character_t end_of_string)
+	{
+		result_type toReturn;
+
+		if (s != NULL)
+			toReturn.insert( toReturn.end(), s, s + (strlen(s, end_of_string) + 1) );
+
+		return toReturn;
+	}
+
+	static result_type empty_result()
+	{
+		return result_type();
+	}
+
+	static uint64_t file_size( const storage_type& s, character_t end_of_string)
+	{
+		return sizeof(uint16_t) + (uint64_t) strlen( s, end_of_string) * sizeof(character_t);
+	}
+
+	static void write( const storage_type& s, FILE* file, character_t end_of_string)
+	{
+		uint16_t translation_size = strlen( s, end_of_string);
+		fwrite( &translation_size, sizeof(uint16_t), 1, file);
+		fwrite( s, sizeof(character_t), translation_size, file);
+	}
+
+	static bool read( FILE* file, container_type& c, character_t end_of_string)
+	{
+		uint16_t translation_size;
+		if (fread( &translation_size, sizeof(uint16_t), 1, file) != 1)
+			return false;
+
+		c.resize( translation_size + 1);
+		if (fread( c.data(), sizeof(character_t), translation_size, file) != translation_size)
+			return false;
+		c[translation_size] = end_of_string;
+
+		return true;
+	}
+};
+
+}
+
+#endif
@@ -3,26 +3,85 @@
 
 #include <string>
 #include <vector>
-#include <fstream>
+#include <memory>
+#include <exception>
+#include <algorithm>
+#include <utility>
+#include <queue>
+#include <thread>
 #include <limits>
 #include <stdint.h>
 #include <type_traits>
 
+#include "trie/alphabet.hpp"
+#include "trie/csv.hpp"
 #include "trie/exceptions.hpp"
+#include "trie/node_options.hpp"
+#include "trie/pattern.hpp"
+#include "trie/reverse_index.hpp"
+#include "trie/translation.hpp"
 #include "trie/trie_node.hpp"
+#include "trie/utf8.hpp"
+#include "trie/word_filter.hpp"
+#include "trie/word_index.hpp"
 
 namespace trie
 {
 
+/* what merge_from does with a word saved in both Tries */
+enum class ConflictPolicy
+{
+	keep_existing,	// keep the translation of the Trie that merges
+	overwrite		// take the translation of the merged Trie
+};
+
+/* how Trie( dictionary_name, LoadMode ) reads the dictionary file */
+enum class LoadMode
+{
+	eager,		// add all entries of the file before the constructor returns
+	lazy,		// add the entries of the words that begin with a character the first time a function needs them
+	parallel	// same as eager, with the segments of the file read by several threads (one per core by default)
+};
+
+/* words (including end_of_string) that differ between a Trie and another one, see Trie::diff */
 template <class character_t>
+struct TrieDiff
+{
+	std::vector< std::vector<character_t> > added;		// saved only in the other Trie
+	std::vector< std::vector<character_t> > removed;	// saved only in this Trie
+	std::vector< std::vector<character_t> > changed;	// saved in both Tries, with different translations
+};
+
+/* memory used by a Trie, see Trie::get_stats */
+struct TrieStats
+{
+	uint64_t entry_count;
+	uint64_t node_count;			// TrieNodes, including emptied ones left behind by lazy pruning
+	uint64_t node_bytes;			// TrieNodes with their zeros_map and children arrays
+	uint64_t translation_bytes;		// translations kept outside of the TrieNodes
+	uint64_t arena_bytes;			// memory of the arenas built by compact (includes TrieNodes counted in node_bytes)
+	uint64_t reverse_index_bytes;	// memory of the reverse index, its table, translations and words (0 if disabled)
+	uint64_t suffix_index_bytes;	// memory of the suffix index, all of its TrieNodes and arenas (0 if disabled)
+	uint64_t word_filter_bytes;		// memory of the word filter (0 if disabled)
+	uint64_t word_index_bytes;		// memory of the hash index of the words (0 if disabled)
+};
+
+template <class character_t, class value_t = std::vector<character_t>, class alphabet_t = FullAlphabet<character_t>, class options_t = NodeOptions<> >
 class Trie
 {
 private:
-	using character_t_parent =
-		typename std::conditional< sizeof(character_t) == 1, uint16_t,
-		typename std::conditional< sizeof(character_t) == 2, uint32_t,
-		typename std::conditional< sizeof(character_t) == 4, uint64_t,
-		void>::type >::type >::type;
+	/* characters given to the Trie are kept as letters of alphabet_t in the TrieNodes (see alphabet.hpp)
+		the default alphabet keeps every character as it is */
+	using letter_t = typename TrieNode<character_t, value_t, alphabet_t, options_t>::letter_t;
+	using letter_t_parent = typename TrieNode<character_t, value_t, alphabet_t, options_t>::letter_t_parent;
+
+	/* how translations are received, saved and returned (see translation.hpp)
+		value_t == std::vector<character_t> : translations are series of characters ending with end_of_string
+		any other trivially copyable value_t : translations are values of that type, kept inline in the TrieNodes */
+	using translation_traits = TranslationTraits<character_t, value_t>;
+	using translation_argument_t = typename translation_traits::argument_type;
+	using translation_container_t = typename translation_traits::container_type;
+	using translation_result_t = typename translation_traits::result_type;
 
 	/* number that should be counted as the end of a series of integers
 	normally, it is 0, like in strings */
@@ -32,59 +91,454 @@ private:
 	std::string dictionary_name;
 
 	/* pointer to the head trie node of the Trie */
-	TrieNode<character_t>* head;
+	TrieNode<character_t, value_t, alphabet_t, options_t>* head;
 
 	/* number of (word -> translation) pairs in the Trie */
 	uint64_t entry_count;
 
+	/* if true, delete_word leaves emptied TrieNodes in the Trie (tombstones, sub-tries with 0 translations)
+		and compact removes all of them in a single pass */
+	bool lazy_pruning;
+
+	/* blocks of memory with TrieNodes placed next to each other by compact, with their sizes
+		freed when the Trie is destructed, or when compact builds a new one
+		copies of the Trie share its TrieNodes, so they share the arenas too, the last one frees them */
+	std::vector< std::pair< std::shared_ptr<char>, uint64_t > > arenas;
+
+	/* optional index of translations to their words (see enable_reverse_index), NULL when disabled
+		copies of the Trie share it, until one of them changes it */
+	std::shared_ptr< ReverseIndex<character_t> > reverse_index;
+
+	/* optional index of the words written backwards (see enable_suffix_index), NULL when disabled
+		translations are kept in this Trie only, the index keeps the words alone */
+	Trie<character_t, uint8_t, alphabet_t>* suffix_index;
+
+	/* optional filter of the saved words (see enable_word_filter), NULL when disabled
+		copies of the Trie share it, until one of them changes it */
+	std::shared_ptr<WordFilter> word_filter;
+
+	/* optional hash index of the saved words to their TrieNodes (see enable_word_index), NULL when disabled
+		copies of the Trie share it (and the TrieNodes), until one of them changes it */
+	std::shared_ptr< WordIndex< character_t, TrieNode<character_t, value_t, alphabet_t, options_t>* > > word_index;
+
+	template <class, class, class, class> friend class Trie;
+
+	/* add (delete) the pair (word, translation) in the reverse index
+		the template version receives translations that are not series of characters, which are never indexed */
+	void reverse_index_update( const character_t* word, uint32_t word_length, const character_t* translation, bool add);
+	template <class other_t>
+	void reverse_index_update( const character_t* word, uint32_t word_length, const other_t& translation, bool add);
+
+	/* add (delete) a word written backwards in the suffix index */
+	void suffix_index_update( const character_t* word, uint32_t word_length, bool add);
+
+	/* call function(word, word_length, translation) for all pairs of a sub-trie (current_word is the word of node)
+		until function returns false, return false in that case */
+	template <class function_t>
+	bool pairs_subtrie( TrieNode<character_t, value_t, alphabet_t, options_t>* node, std::vector<character_t>& current_word, function_t& function);
+
+	/* delete the pairs of a sub-trie from the reverse, suffix and word indexes, before the sub-trie is deleted */
+	void unindex_subtrie( TrieNode<character_t, value_t, alphabet_t, options_t>* node, std::vector<character_t>& current_word);
+
+	/* build the reverse (suffix) index again for all pairs of the Trie, after changes of many pairs at once */
+	void rebuild_reverse_index();
+	void rebuild_suffix_index();
+
+	/* build a new word filter for all words of the Trie, with room for as many new words
+		word_filter_update adds (counts as removed) a word, or removed_words words, and builds a new filter if this one is worn out
+		lazy mode: the filter read from the file keeps the pending words, it is built again only after all segments are added */
+	void rebuild_word_filter();
+	void word_filter_update( const character_t* word, uint32_t word_length, bool add);
+	void word_filter_update( uint64_t removed_words);
+
+	/* build the word index again for all words of the Trie, after changes of many TrieNodes at once (e.g. compact)
+		own_word_index copies the index if copies of the Trie share it, index_subtrie adds the words of a sub-trie */
+	void rebuild_word_index();
+	void own_word_index();
+	void index_subtrie( TrieNode<character_t, value_t, alphabet_t, options_t>* node, std::vector<character_t>& current_word);
+
+	/* delete all TrieNodes and free all arenas */
+	void clear_nodes();
+
+	/* TrieNodes shared with copies of the Trie are copied before they change, so that the copies never see the change
+		own_head copies the head, own_child copies the child of node (owned by this Trie) for letter, and returns the copy
+		unshare_path does the same for path[0], path[1], ..., path[depth], the TrieNodes of the first depth characters of word
+		and points the word index to the copies */
+	void own_head();
+	TrieNode<character_t, value_t, alphabet_t, options_t>* own_child( TrieNode<character_t, value_t, alphabet_t, options_t>* node, letter_t letter, TrieNode<character_t, value_t, alphabet_t, options_t>* child);
+	void unshare_path( TrieNode<character_t, value_t, alphabet_t, options_t>** path, uint32_t depth, const character_t* word);
+
+	/* return true if the word and the translation given as argument respect the limits of the Trie and the alphabet */
+	bool can_add( const character_t* word, uint32_t word_length, uint32_t translation_length);
+
+	/* add a word, starting from the TrieNode of its first depth characters
+		insert_path keeps the TrieNodes of the path (0 to depth already set) and gets filled up to the end of the word */
+	bool add_from_path( TrieNode<character_t, value_t, alphabet_t, options_t>** insert_path, uint32_t depth,
+						const character_t* word, uint32_t word_length, translation_argument_t translation, uint32_t translation_length, uint32_t score);
+
+	/* update the max. scores of path[depth], path[depth-1], ..., path[0], until one of them doesn't change */
+	void update_max_scores( TrieNode<character_t, value_t, alphabet_t, options_t>** path, uint32_t depth);
+
+	/* dictionary files start with the character size (1 byte) and the number of entries (8 bytes)
+		the highest bit of the character size marks an extended header, where a byte of flags follows the character size
+		entries are [word size (1 byte)][word][translation size (2 bytes)][translation], followed by the parts marked in the flags */
+	enum file_flags : uint8_t
+	{
+		FILE_EXTENDED_HEADER = 0x80,	// in the character size
+		FILE_SCORES = 0x01,				// score of every entry (4 bytes)
+		FILE_REVERSE_INDEX = 0x02,		// the Trie keeps a reverse index, saved after the segment index (see ReverseIndex::write)
+		FILE_SUFFIX_INDEX = 0x04,		// the Trie keeps a suffix index (no data, the index is filled while the entries are read)
+		FILE_WORD_FILTER = 0x08,		// the Trie keeps a word filter, saved after the segment index (see WordFilter::write)
+		FILE_WORD_INDEX = 0x10			// the Trie keeps a word index (no data, same as FILE_SUFFIX_INDEX)
+	};
+
+	/* entries of the words that begin with the same character are saved next to each other (a segment), in the order of the characters
+		after the last entry, the file keeps [number of segments (8 bytes)][segments]([word filter])([reverse index])[position of the number of segments (8 bytes)][FILE_SEGMENTS_MARK (8 bytes)]
+		every segment is [character][position of its first entry (8 bytes)][number of entries (8 bytes)]
+		the entry of the empty word, if there is one, comes before all segments
+		readers that only read the entries never see the segment index, so the header doesn't mark it */
+	static const uint64_t FILE_SEGMENTS_MARK = 0x5345474D454E5453ULL;
+	struct file_segment
+	{
+		character_t character;
+		uint64_t offset;
+		uint64_t count;
+	};
+
+	/* lazy mode: segments of the dictionary file that are not added in the Trie yet, in the order of their characters
+		with the number of their entries and the flags of the file */
+	std::vector<file_segment> pending_segments;
+	uint64_t pending_count;
+	uint8_t pending_flags;
+
+	/* read count entries of a dictionary file (with the flags of its header) starting from the current position, and add them
+		the word filter and the reverse index are not updated, the ones saved in the file already have the words of the file
+		throw ErrorReadingDictionaryException if a translation doesn't fit in the Trie */
+	void read_entries( FILE* file, uint64_t count, uint8_t flags);
+
+	/* lazy mode: add the pending segment of the words that begin with character, if there is one */
+	void load_segment( character_t character);
+
+	/* split segments in at most threads groups of neighbouring segments, with about the same number of entries
+		group i is [groups[i], groups[i+1]) */
+	static std::vector<size_t> segment_groups( const std::vector<file_segment>& segments, unsigned threads);
+
+	/* call function(group) for every group of segments, each group on its own thread (the 1st one on the calling thread)
+		function must not throw */
+	template <class function_t>
+	static void for_each_group( const std::vector<size_t>& groups, function_t function);
+
+	/* parallel mode: add all pending segments, every group of segments is read by its own thread in a separate Trie
+		and the sub-tries of the separate Tries are then moved under head (see merge_from) */
+	void load_segments_parallel( unsigned threads);
+
+	/* lazy mode: add the segments a word can be saved in (the segment of its first character)
+		or the segments that the words beginning with a prefix can be saved in (all segments for an empty prefix) */
+	void load_word_segment( const character_t* word, uint32_t word_length);
+	void load_prefix_segments( const character_t* prefix, uint32_t prefix_length);
+
+	/* set characters (length) to a field of a csv record as a series of characters ending with end_of_string, see insert_from_csv
+		return false if the field is not valid UTF-8 */
+	bool csv_field( CsvField& field, std::vector<character_t>& decoded, const character_t*& characters, uint32_t& length);
+
+	/* return the child of the TrieNode given as argument that follows the path of the character given as argument
+		return NULL if there doesn't exist one, or if the alphabet doesn't contain the character */
+	TrieNode<character_t, value_t, alphabet_t, options_t>* get_child_node( TrieNode<character_t, value_t, alphabet_t, options_t>* node, character_t character);
+
+	/* recursive parts of merge_from, diff and intersect, for two TrieNodes of the same word (current_word)
+		merge and intersect return the number of added/removed words of the sub-trie */
+	uint64_t merge_subtrie( TrieNode<character_t, value_t, alphabet_t, options_t>* node, TrieNode<character_t, value_t, alphabet_t, options_t>* other_node, ConflictPolicy policy);
+	void diff_subtrie( TrieNode<character_t, value_t, alphabet_t, options_t>* node, TrieNode<character_t, value_t, alphabet_t, options_t>* other_node,
+						std::vector<character_t>& current_word, TrieDiff<character_t>& result);
+	uint64_t intersect_subtrie( TrieNode<character_t, value_t, alphabet_t, options_t>* node, TrieNode<character_t, value_t, alphabet_t, options_t>* other_node);
+
+	/* visit the words of a sub-trie within max_edits edits of word, used by fuzzy_search
+		rows keeps one row of the edit distance table per depth, the row of node (depth current_word.size()) is already filled */
+	bool fuzzy_subtrie( TrieNode<character_t, value_t, alphabet_t, options_t>* node, std::vector<character_t>& current_word,
+						const character_t* word, uint32_t word_length, uint32_t max_edits, std::vector<uint32_t>& rows, int64_t& count,
+						std::vector< std::pair< std::vector<character_t>, uint32_t > >& result);
+
+	/* visit the words of a sub-trie that match pattern, used by for_each_match
+		states keeps the pattern states of every depth, the states of node (depth current_word.size()) are already set */
+	template <class function_t>
+	bool match_subtrie( TrieNode<character_t, value_t, alphabet_t, options_t>* node, std::vector<character_t>& current_word,
+						Pattern<character_t>& pattern, std::vector< typename Pattern<character_t>::states_t >& states, int64_t& count, function_t& function);
+
+	/* visit the words of a sub-trie that are in the range [lo, hi), used by for_each_in_range
+		lo (hi) is NULL when the sub-trie is not on the path of lo (hi) anymore */
+	template <class function_t>
+	bool range_subtrie( TrieNode<character_t, value_t, alphabet_t, options_t>* node, std::vector<character_t>& current_word,
+						const character_t* lo, const character_t* hi, int64_t& count, function_t& function);
+
 public:
 	Trie( character_t eos = 0);
 	Trie( std::string dictionary_name, character_t eos = 0);
 	~Trie();
 
+	/* open a dictionary file, either adding all of its entries at once (same as above) or lazily
+		lazy: only the segment index of the file is read (see save_changes), the entries of the words that begin with a character
+		are added the first time a function looks for such a word, functions that visit all words (e.g. rank, merge_from, save_changes)
+		add all segments first. Copies of the Trie keep the pending segments and add them on their own
+		the file shouldn't change while a Trie that was read from it (or a copy of it) has pending segments
+		files saved without a segment index are read eagerly
+		parallel: the segments are read by load_threads threads, 0 for one thread per core */
+	Trie( std::string dictionary_name, LoadMode mode, character_t eos = 0, unsigned load_threads = 0);
+
+	/* lazy mode: add all segments that are not added yet, e.g. while the process has nothing else to do */
+	void prefetch();
+
+	/* lazy mode: return number of entries of the dictionary file that are not added in the Trie yet */
+	uint64_t get_pending_count();
+
+	/* copy (snapshot) of a Trie in O(1), both Tries share all TrieNodes, arenas and indexes until one of them changes
+		a change copies only the TrieNodes of the changed path (copy-on-write), all other TrieNodes stay shared
+		so older versions of a dictionary can be kept for rollbacks, or compared with diff, for the memory of their differences
+		Tries that share TrieNodes can't be changed by different threads at the same time */
+	Trie( const Trie& other);
+
+	/* replace all pairs with the pairs of other, in O(1) as above (e.g. a rollback to a snapshot)
+		throw ConflictingTriesException if the end_of_string of the Tries differs */
+	Trie& operator=( const Trie& other);
+
+	/* return a copy of the Trie, see Trie( const Trie& ) */
+	Trie snapshot();
+
 	/* return true if Trie has 0 translations saved */
 	bool is_empty();
 
+	/* choose between removing emptied TrieNodes on every delete_word (default) or leaving them for compact */
+	void set_lazy_pruning( bool lazy);
+
+	/* remove all emptied TrieNodes left behind by delete_word with lazy pruning
+		then rebuild the Trie in a single block of memory, in depth-first order, with arrays of exact size
+		a lookup then reads a TrieNode, its arrays and usually its first child from neighbouring memory
+		the Trie keeps working as before, TrieNodes changed later are allocated one by one again
+		best called after bulk imports */
+	void compact();
+
+	/* return the memory used by the Trie */
+	TrieStats get_stats();
+
 	/* return number of saved translations */
 	uint64_t get_entry_count();
 
+	/* Every function that receives a word offers
+		1) a version for a series of characters ending with end_of_string
+		2) a version for a series of characters with a known length (no scan for end_of_string, which can also exist inside the word)
+		3) a version for a vector that includes the end_of_string
+		lengths are computed once, when the function is called, so 1) and 3) always end up in 2) */
+
 	/* search for the translation of a word in the Trie
-		return a pointer to the translation of the word
-		return NULL if the word given doesn't exist in the Trie */
-	std::vector<character_t> search_word( const character_t* word);
-	std::vector<character_t> search_word( const std::vector<character_t> word);
+		string translations: return a copy of the translation (empty if the word given doesn't exist in the Trie)
+		other values: return a pointer to the value of the word (NULL if the word given doesn't exist in the Trie) */
+	translation_result_t search_word( const character_t* word);
+	translation_result_t search_word( const character_t* word, uint32_t word_length);
+	translation_result_t search_word( const std::vector<character_t> word);
 
 	/* add a new word with its translation in the Trie
 		return false if the word given already exists in the Trie
 		or if the trie has the maximum number of translations (4294967295) */
-	bool add_word( const character_t* word, const character_t* translation);
-	bool add_word( const std::vector<character_t> word, const std::vector<character_t> translation);
+	bool add_word( const character_t* word, translation_argument_t translation);
+	bool add_word( const character_t* word, uint32_t word_length, translation_argument_t translation);
+	bool add_word( const std::vector<character_t> word, const translation_container_t translation);
+
+	/* add a new word with its translation and a score (see top_k_completions), words added without one have a score of 0
+		Tries without NodeOptions scores ignore the score */
+	bool add_word( const character_t* word, uint32_t word_length, translation_argument_t translation, uint32_t score);
+
+	/* change the score of a saved word, return false if the word given doesn't exist in the Trie
+		scores are kept only by Tries with NodeOptions scores */
+	bool set_score( const character_t* word, uint32_t score);
+	bool set_score( const character_t* word, uint32_t word_length, uint32_t score);
+	bool set_score( const std::vector<character_t> word, uint32_t score);
+
+	/* return the score of a saved word (0 if the word given doesn't exist in the Trie) */
+	uint32_t get_score( const character_t* word);
+	uint32_t get_score( const character_t* word, uint32_t word_length);
+	uint32_t get_score( const std::vector<character_t> word);
+
+	/* add many words (including end_of_string) with their translations (same index) in the Trie
+		words are added in lexicographic order, every word starts from the path of the previous one
+		instead of the head, which is faster for sorted or clustered words
+		return, for every word, what add_word would return (false for words without a translation) */
+	std::vector<bool> add_batch( const std::vector< std::vector<character_t> >& words, const std::vector<translation_container_t>& translations);
 
 	/* delete a word from the Trie with its translation
 		return false if the word given doesn't exist in the Trie */
 	bool delete_word( const character_t* word);
+	bool delete_word( const character_t* word, uint32_t word_length);
 	bool delete_word( const std::vector<character_t> word);
 
+	/* delete all words that begin with the prefix given as argument (including the prefix itself), with their translations
+		the whole sub-trie of the prefix is detached from its parent at once
+		return number of deleted words */
+	uint64_t delete_prefix( const character_t* prefix);
+	uint64_t delete_prefix( const character_t* prefix, uint32_t prefix_length);
+	uint64_t delete_prefix( const std::vector<character_t> prefix);
+
 	/* modify a word and its translation */
 	// bool modify_word( const character_t* word, const character_t* translation);
 	// bool modify_word( const character_t* old_word, const character_t* new_word, const character_t* translation);
 
+	/* keep a reverse index of the translations (a hash table of translations to their words, see reverse_index.hpp)
+		so that search_translation costs as much as search_word, Tries of string translations only
+		the index is updated by every change of the Trie, and saved with the dictionary file, so that it is read back
+		as it is instead of being built again (lazy mode: search_translation doesn't add the pending segments) */
+	void enable_reverse_index();
+	void disable_reverse_index();
+	bool has_reverse_index();
+
+	/* get all words with the translation given as argument, in lexicographic order, each including the end_of_string
+		without a reverse index, all pairs of the Trie are visited */
+	std::vector< std::vector<character_t> > search_translation( const character_t* translation);
+	std::vector< std::vector<character_t> > search_translation( const std::vector<character_t> translation);
+
+	/* keep a suffix index, a Trie of all words written backwards, for get_suffix_words
+		the index is updated by every change of the Trie and saved with the dictionary file */
+	void enable_suffix_index();
+	void disable_suffix_index();
+	bool has_suffix_index();
+
+	/* get a vector of max. n words saved in the Trie that end with the suffix given as argument (negative n sets no limit)
+		words are ordered by their characters from the last one to the first one (e.g. "going" before "ring" before "bring")
+		without a suffix index, all words of the Trie are visited */
+	std::vector< std::vector<character_t> > get_suffix_words( const character_t* suffix, int64_t n);
+	std::vector< std::vector<character_t> > get_suffix_words( const character_t* suffix, uint32_t suffix_length, int64_t n);
+	std::vector< std::vector<character_t> > get_suffix_words( const std::vector<character_t> suffix, int64_t n);
+
+	/* keep a filter of all saved words (a blocked Bloom filter, see word_filter.hpp), checked by search_word before the descent
+		most lookups of words that are not saved then read a single block of 64 bytes instead of a TrieNode per character
+		add_word adds words to the filter, deleted words stay in it until it is built again, when it runs out of room,
+		when most of its words are deleted, and on compact
+		the filter is saved with the dictionary file, so lazy mode doesn't add the segments of words that the filter rules out */
+	void enable_word_filter();
+	void disable_word_filter();
+	bool has_word_filter();
+
+	/* keep a hash index of all saved words to their TrieNodes, so that search_word finds a word with a single probe
+		(usually one cache line for the slot, one for the word and one for its TrieNode) instead of a TrieNode per character
+		prefix, range, pattern and fuzzy queries keep using the Trie
+		the index is updated by every change of the Trie, changes of many TrieNodes at once (compact, merge_from, intersect)
+		build it again, and it is saved with the dictionary file (no data, the index is filled while the entries are read) */
+	void enable_word_index();
+	void disable_word_index();
+	bool has_word_index();
+
 	/* get a vector of words saved in the Trie that begin with the word given as argument  */
 	std::vector< std::vector<character_t> > get_prefix_words( const character_t* word, int64_t n);
+	std::vector< std::vector<character_t> > get_prefix_words( const character_t* word, uint32_t word_length, int64_t n);
 	std::vector< std::vector<character_t> > get_prefix_words( const std::vector<character_t> word, int64_t n);
 
-	/* write current information of trie in the binary dictionary file */
+	/* get the k words with the biggest scores that begin with the prefix given as argument, with their scores
+		biggest score first, words with the same score in lexicographic order
+		sub-tries are visited best-first by their max. score, so sub-tries that can't make it in the k best words are never visited
+		the Trie needs NodeOptions scores */
+	std::vector< std::pair< std::vector<character_t>, uint32_t > > top_k_completions( const character_t* prefix, uint64_t k);
+	std::vector< std::pair< std::vector<character_t>, uint32_t > > top_k_completions( const character_t* prefix, uint32_t prefix_length, uint64_t k);
+	std::vector< std::pair< std::vector<character_t>, uint32_t > > top_k_completions( const std::vector<character_t> prefix, uint64_t k);
+
+	/* get the saved words that are at most max_edits edits (insertions, deletions, substitutions of a character) away from
+		the word given as argument, with their edit distances, in lexicographic order, max. n words (a negative n sets no limit)
+		the edit distance table of the word is filled one row per TrieNode of the descent, only for the band of max_edits
+		cells around the diagonal, and sub-tries whose row has no cell within max_edits are never visited
+		words longer than 253 + max_edits characters match no saved word, and return no words at once */
+	std::vector< std::pair< std::vector<character_t>, uint32_t > > fuzzy_search( const character_t* word, uint32_t max_edits, int64_t n);
+	std::vector< std::pair< std::vector<character_t>, uint32_t > > fuzzy_search( const character_t* word, uint32_t word_length, uint32_t max_edits, int64_t n);
+	std::vector< std::pair< std::vector<character_t>, uint32_t > > fuzzy_search( const std::vector<character_t> word, uint32_t max_edits, int64_t n);
+
+	/* find the longest word saved in the Trie that is a prefix of the key given as argument, in a single descent
+		return its translation (same as search_word) and set matched_length to its length
+		return an empty translation and set matched_length to 0 if no saved word is a prefix of the key */
+	translation_result_t longest_prefix_match( const character_t* key, uint32_t& matched_length);
+	translation_result_t longest_prefix_match( const character_t* key, uint32_t key_length, uint32_t& matched_length);
+	translation_result_t longest_prefix_match( const std::vector<character_t> key, uint32_t& matched_length);
+
+	/* get all words saved in the Trie that are prefixes of the key given as argument, shortest first */
+	std::vector< std::vector<character_t> > get_matching_prefixes( const character_t* key);
+	std::vector< std::vector<character_t> > get_matching_prefixes( const character_t* key, uint32_t key_length);
+	std::vector< std::vector<character_t> > get_matching_prefixes( const std::vector<character_t> key);
+
+	/* return number of words saved in the Trie that begin with the prefix given as argument
+		reads the sub-trie counts of the TrieNodes, without visiting the words themselves
+		count_prefix, rank and select need a Trie with NodeOptions counts (see node_options.hpp) */
+	uint64_t count_prefix( const character_t* prefix);
+	uint64_t count_prefix( const character_t* prefix, uint32_t prefix_length);
+	uint64_t count_prefix( const std::vector<character_t> prefix);
+
+	/* return lexicographic position of the word given as argument (number of saved words smaller than it)
+		the word itself doesn't need to be saved in the Trie */
+	uint64_t rank( const character_t* word);
+	uint64_t rank( const character_t* word, uint32_t word_length);
+	uint64_t rank( const std::vector<character_t> word);
+
+	/* return the k-th (starting from 0) saved word in lexicographic order
+		return an empty vector if k is bigger or equal to the number of saved words */
+	std::vector<character_t> select( uint64_t k);
+
+	/* call function(word, translation) for every saved word w with lo <= w < hi, in lexicographic order, until n words are visited
+		a NULL lo (hi) leaves that side of the range open, a negative n sets no limit
+		word (ending with end_of_string) lives in a single buffer reused for all words, translation lives in the Trie
+		both are valid only during the call
+		return number of visited words */
+	template <class function_t>
+	uint64_t for_each_in_range( const character_t* lo, const character_t* hi, int64_t n, function_t function);
+
+	/* get a vector of saved words w with lo <= w < hi, max. n words */
+	std::vector< std::vector<character_t> > get_range_words( const character_t* lo, const character_t* hi, int64_t n);
+	std::vector< std::vector<character_t> > get_range_words( const std::vector<character_t> lo, const std::vector<character_t> hi, int64_t n);
+
+	/* call function(word, translation) for every saved word that matches the pattern given as argument, in lexicographic order,
+		until n words are visited (a negative n sets no limit), see pattern.hpp for the syntax (?, *, [a-z], [!a-z], \)
+		only the children that the pattern allows are visited, children of literal characters are looked up directly
+		word and translation are valid only during the call, same as for_each_in_range
+		throw InvalidPatternException if the pattern is not valid
+		return number of visited words */
+	template <class function_t>
+	uint64_t for_each_match( const character_t* pattern, int64_t n, function_t function);
+	template <class function_t>
+	uint64_t for_each_match( const character_t* pattern, uint32_t pattern_length, int64_t n, function_t function);
+
+	/* get a vector of saved words that match the pattern given as argument, max. n words */
+	std::vector< std::vector<character_t> > get_pattern_words( const character_t* pattern, int64_t n);
+	std::vector< std::vector<character_t> > get_pattern_words( const std::vector<character_t> pattern, int64_t n);
+
+	/* The following functions walk both Tries in lockstep, visiting only their common TrieNodes and the
+		sub-tries saved in just one of them. Both Tries need the same end_of_string (ConflictingTriesException otherwise) */
+
+	/* move all words of the other Trie in this Trie, the other Trie is left empty
+		sub-tries that exist only in the other Trie are moved as they are, without visiting their words
+		return number of words added in this Trie */
+	uint64_t merge_from( Trie& other, ConflictPolicy policy = ConflictPolicy::keep_existing);
+
+	/* return the words added, removed and changed in the other Trie compared to this Trie, each in lexicographic order
+		translations that are not series of characters are compared with the operator== of value_t */
+	TrieDiff<character_t> diff( Trie& other);
+
+	/* keep only the words (with their translations) that are also saved in the other Trie
+		return number of deleted words */
+	uint64_t intersect( Trie& other);
+
+	/* write current information of trie in the binary dictionary file
+		entries are written in lexicographic order, followed by an index of the segments of their first characters */
 	void save_changes();
+
+	/* same, with groups of segments written by different threads (threads of them), each one at its own position of the file
+		the sizes of all segments are measured first (also in parallel), the file is the same as with save_changes() */
+	void save_changes( unsigned threads);
 	
 	/* functions used to insert and delete pairs of (word,translation)
 		insert can be used to import an already existing dictionary .csv file
-		delete is used mainly for debugging and ignored the provided translation */
-	void insert_from_csv( std::string filename);
-	void delete_from_csv( std::string filename);
+		delete is used mainly for debugging and ignored the provided translation
+		the file is read in large blocks, see csv.hpp for the accepted format
+		Tries of uint8_t keep every byte of the file as a character of the word (translation)
+		Tries of uint16_t (uint32_t) read the file as UTF-8 and keep UTF-16 code units (code points), see utf8.hpp
+		return counters of the records that were accepted, rejected and malformed */
+	CsvStats insert_from_csv( std::string filename);
+	CsvStats delete_from_csv( std::string filename);
 };
 
-template <class character_t>
-Trie<character_t>::Trie( character_t eos) : end_of_string(eos)
+template <class character_t, class value_t, class alphabet_t, class options_t>
+Trie<character_t, value_t, alphabet_t, options_t>::Trie( character_t eos) : end_of_string(eos)
 {
 	// check if the type given is valid for the template class
 	uint8_t bytes;
@@ -100,13 +554,22 @@ Trie<character_t>::Trie( character_t eos) : end_of_string(eos)
 	// 0 entries, dictionary name empty, set end_of_string
 	this->entry_count = 0;
 	this->dictionary_name = "";
+	this->lazy_pruning = false;
+	this->pending_count = 0;
+	this->pending_flags = 0;
+	this->suffix_index = NULL;
 
 	// set up head node
-	this->head = new TrieNode<character_t>();
+	this->head = new TrieNode<character_t, value_t, alphabet_t, options_t>();
 }
 
-template <class character_t>
-Trie<character_t>::Trie( std::string dictionary_name, character_t eos) : end_of_string(eos)
+template <class character_t, class value_t, class alphabet_t, class options_t>
+Trie<character_t, value_t, alphabet_t, options_t>::Trie( std::string dictionary_name, character_t eos) : Trie( dictionary_name, LoadMode::eager, eos)
+{
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+Trie<character_t, value_t, alphabet_t, options_t>::Trie( std::string dictionary_name, LoadMode mode, character_t eos, unsigned load_threads) : end_of_string(eos)
 {
 	// check if the type given is valid for the template class
 	uint8_t bytes;
@@ -122,6 +585,10 @@ Trie<character_t>::Trie( std::string dictionary_name, character_t eos) : end_of_
 	// 0 entries, dictionary name, set end_of_string
 	this->entry_count = 0;
 	this->dictionary_name = dictionary_name;
+	this->lazy_pruning = false;
+	this->pending_count = 0;
+	this->pending_flags = 0;
+	this->suffix_index = NULL;
 
 	// open dictionary file to read it
 	uint8_t character_size;
@@ -144,356 +611,2590 @@ Trie<character_t>::Trie( std::string dictionary_name, character_t eos) : end_of_
 			throw ErrorOpeningDictionaryException(this->dictionary_name);
 	}
 
-	// read character size for this dictionary
+	// read character size for this dictionary, and the flags of an extended header
+	uint8_t flags = 0;
 	fread( &character_size, sizeof(uint8_t), 1, file);
+	if (character_size & FILE_EXTENDED_HEADER)
+	{
+		fread( &flags, sizeof(uint8_t), 1, file);
+		character_size &= ~FILE_EXTENDED_HEADER;
+	}
+
 	if (character_size != bytes)
 	{
 		fclose(file);
 		throw ErrorReadingDictionaryException( this->dictionary_name, "Conflicting Trie and File types");
 	}
 
-	// set up head node
-	this->head = new TrieNode<character_t>();
+	if ( (flags & ~(FILE_SCORES | FILE_REVERSE_INDEX | FILE_SUFFIX_INDEX | FILE_WORD_FILTER | FILE_WORD_INDEX)) ||
+		 ((flags & FILE_REVERSE_INDEX) && !std::is_same< value_t, std::vector<character_t> >::value) )
+	{
+		fclose(file);
+		throw ErrorReadingDictionaryException( this->dictionary_name, "Unknown file options");
+	}
+
+	// set up head node, and the indexes filled by add_word
+	this->head = new TrieNode<character_t, value_t, alphabet_t, options_t>();
+	if (flags & FILE_SUFFIX_INDEX)
+		this->suffix_index = new Trie<character_t, uint8_t, alphabet_t>( this->end_of_string );
+	if (flags & FILE_WORD_INDEX)
+		this->word_index = std::make_shared< WordIndex< character_t, TrieNode<character_t, value_t, alphabet_t, options_t>* > >();
 
 	// read total number of entries to insert in the trie
 	uint64_t local_entry_count;
 	fread( &local_entry_count, sizeof(uint64_t), 1, file);
 
+	// read the segment index at the end of the file, only the entries before the first segment are read now
+	// the word filter and the reverse index follow the segments, the index is read in eager mode too when there is one of them
+	uint64_t first_entries = local_entry_count;
+	long entries_position = ftell(file);
+	uint64_t index_position = 0, mark = 0;
+	if ( ((mode != LoadMode::eager) || (flags & (FILE_WORD_FILTER | FILE_REVERSE_INDEX))) && (fseek( file, -2 * (long) sizeof(uint64_t), SEEK_END) == 0) && (ftell(file) >= entries_position) &&
+		 (fread( &index_position, sizeof(uint64_t), 1, file) == 1) && (fread( &mark, sizeof(uint64_t), 1, file) == 1) &&
+		 (mark == FILE_SEGMENTS_MARK) )
+	{
+		// the footer (position of the index and mark) ends the file
+		long footer_position = ftell(file) - 2 * (long) sizeof(uint64_t);
+		uint64_t segments_count;
+		bool valid = (fseek( file, (long) index_position, SEEK_SET) == 0) && (fread( &segments_count, sizeof(uint64_t), 1, file) == 1);
+
+		std::vector<file_segment> segments;
+		uint64_t segment_entries = 0;
+		file_segment segment;
+		for (uint64_t i=0; valid && (i < segments_count); i++)
+		{
+			valid = (fread( &segment.character, sizeof(character_t), 1, file) == 1) && (fread( &segment.offset, sizeof(uint64_t), 1, file) == 1) &&
+					(fread( &segment.count, sizeof(uint64_t), 1, file) == 1) && (segment.count <= local_entry_count - segment_entries);
+			if (valid)
+			{
+				segments.push_back( segment );
+				segment_entries += segment.count;
+			}
+		}
+
+		if (valid && (flags & FILE_WORD_FILTER))
+		{
+			long filter_position = ftell(file);
+			this->word_filter = std::make_shared<WordFilter>( 0 );
+			valid = (filter_position <= footer_position) && this->word_filter->read( file, (uint64_t) (footer_position - filter_position) );
+		}
+
+		if (valid && (flags & FILE_REVERSE_INDEX))
+		{
+			long reverse_position = ftell(file);
+			this->reverse_index = std::make_shared< ReverseIndex<character_t> >();
+			valid = (reverse_position <= footer_position) && this->reverse_index->read( file, (uint64_t) (footer_position - reverse_position) );
+		}
+
+		if ( !valid || (fseek( file, entries_position, SEEK_SET) != 0) )
+		{
+			TrieNode<character_t, value_t, alphabet_t, options_t>::destroy( this->head );
+			delete this->suffix_index;
+			fclose(file);
+			throw ErrorReadingDictionaryException( this->dictionary_name, "Broken segment index");
+		}
+
+		if (mode != LoadMode::eager)
+		{
+			this->pending_segments.swap( segments );
+			first_entries -= segment_entries;
+			this->pending_count = segment_entries;
+			this->pending_flags = flags;
+		}
+	}
+	else if (flags & (FILE_WORD_FILTER | FILE_REVERSE_INDEX))
+	{
+		TrieNode<character_t, value_t, alphabet_t, options_t>::destroy( this->head );
+		delete this->suffix_index;
+		fclose(file);
+		throw ErrorReadingDictionaryException( this->dictionary_name, "Broken segment index");
+	}
+	else
+	{
+		fseek( file, entries_position, SEEK_SET);
+	}
+
 	// read and add entries
+	try
+	{
+		this->read_entries( file, first_entries, flags);
+
+		if (mode == LoadMode::parallel)
+			this->load_segments_parallel( (load_threads != 0) ? load_threads : std::max( std::thread::hardware_concurrency(), 1u ) );
+	}
+	catch (...)
+	{
+		TrieNode<character_t, value_t, alphabet_t, options_t>::destroy( this->head );
+		delete this->suffix_index;
+		fclose(file);
+		throw;
+	}
+
+	// close dictionary file
+	fclose(file);
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::read_entries( FILE* file, uint64_t count, uint8_t flags)
+{
 	uint8_t word_size;
-	uint16_t translation_size;
-	character_t* current_word;
-	character_t* current_translation;
-	for (uint64_t i=0; i < local_entry_count; i++)
+	character_t current_word[ std::numeric_limits<uint8_t>::max() + 1 ];
+	translation_container_t current_translation;
+	uint32_t current_score = 0;
+
+	std::shared_ptr<WordFilter> filter;
+	std::shared_ptr< ReverseIndex<character_t> > reverse;
+	filter.swap( this->word_filter );
+	reverse.swap( this->reverse_index );
+	for (uint64_t i=0; i < count; i++)
 	{
 		// read word
 		fread( &word_size, sizeof(uint8_t), 1, file);
-		current_word = new character_t[word_size+1];
 		fread( current_word, sizeof(character_t), word_size, file);
 		current_word[word_size] = this->end_of_string;
 
 		// read translation
-		fread( &translation_size, sizeof(uint16_t), 1, file);
-		current_translation = new character_t[translation_size+1];
-		fread( current_translation, sizeof(character_t), translation_size, file);
-		current_translation[translation_size] = this->end_of_string;
+		if ( !translation_traits::read( file, current_translation, this->end_of_string) )
+		{
+			this->word_filter.swap( filter );
+			this->reverse_index.swap( reverse );
+			throw ErrorReadingDictionaryException( this->dictionary_name, "Conflicting translation sizes");
+		}
 
-		// add tuple
-		this->add_word( current_word, current_translation);
+		if (flags & FILE_SCORES)
+			fread( &current_score, sizeof(uint32_t), 1, file);
 
-		// prepare for next word
-		delete[] current_word;
-		delete[] current_translation;
+		// add tuple, size of the word is already known
+		this->add_word( current_word, word_size, translation_traits::to_argument(current_translation), current_score );
 	}
-
-	// close dictionary file
-	fclose(file);
+	this->word_filter.swap( filter );
+	this->reverse_index.swap( reverse );
 }
 
-template <class character_t>
-Trie<character_t>::~Trie()
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::load_segment( character_t character)
 {
-	//  start deleting nodes from head, recursively
-	delete this->head;
-}
+	auto segment = std::lower_bound( this->pending_segments.begin(), this->pending_segments.end(), character,
+									 []( const file_segment& s, character_t c) { return s.character < c; } );
+	if ( (segment == this->pending_segments.end()) || (segment->character != character) )
+		return;
 
-template <class character_t>
-bool Trie<character_t>::is_empty()
-{
-	return this->head->is_empty();
-}
+	// not pending anymore, add_word doesn't look for it again
+	file_segment loaded = *segment;
+	this->pending_segments.erase( segment );
+	this->pending_count -= loaded.count;
 
-template <class character_t>
-std::vector<character_t> Trie<character_t>::search_word( const character_t* word)
-{
-	// read existing Trie until you reach unsaved part of the word
-	// for a successful search, we should not have an unsaved part
-	TrieNode<character_t>* current = this->head;
-	TrieNode<character_t>* previous = NULL;
-	uint8_t current_word_position = 0;
-	while (current != NULL)
+	FILE* file = fopen( this->dictionary_name.c_str(), "rb");
+	if (file == NULL)
+		throw ErrorOpeningDictionaryException(this->dictionary_name);
+
+	if (fseek( file, (long) loaded.offset, SEEK_SET) != 0)
 	{
-		previous = current;
-		current = current->get_node_if_possible( word[current_word_position] );
+		fclose(file);
+		throw ErrorReadingDictionaryException( this->dictionary_name, "Broken segment index");
+	}
 
-		++current_word_position;
+	try
+	{
+		this->read_entries( file, loaded.count, this->pending_flags);
+	}
+	catch (ErrorReadingDictionaryException&)
+	{
+		fclose(file);
+		throw;
 	}
-	current_word_position--;
 
-	std::vector<character_t> toReturn;
+	fclose(file);
+}
 
-	// report an error if word given is not saved or it doesn't have a translation
-	if ( (strlen( word, this->end_of_string) != current_word_position) || (previous->get_translation() == NULL) )
-		return toReturn;
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector<size_t> Trie<character_t, value_t, alphabet_t, options_t>::segment_groups( const std::vector<file_segment>& segments, unsigned threads)
+{
+	std::vector<size_t> toReturn( 1, 0 );
+
+	uint64_t total = 0;
+	for (const file_segment& segment : segments)
+		total += segment.count;
 
-	toReturn.insert( toReturn.end(), previous->get_translation(), previous->get_translation() + (strlen(previous->get_translation(), this->end_of_string) + 1) );
+	uint64_t group_size = total / std::max( threads, 1u ) + 1;
+	uint64_t current_size = 0;
+	for (size_t i=0; i < segments.size(); i++)
+	{
+		current_size += segments[i].count;
+		if ( (current_size >= group_size) && (i + 1 < segments.size()) )
+		{
+			toReturn.push_back( i + 1 );
+			current_size = 0;
+		}
+	}
+	toReturn.push_back( segments.size() );
 
 	return toReturn;
 }
 
-template <class character_t>
-std::vector<character_t> Trie<character_t>::search_word( const std::vector<character_t> word )
+template <class character_t, class value_t, class alphabet_t, class options_t>
+template <class function_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::for_each_group( const std::vector<size_t>& groups, function_t function)
 {
-	return this->search_word( word.data() );
+	std::vector<std::thread> workers;
+	for (size_t group=1; group + 1 < groups.size(); group++)
+		workers.push_back( std::thread( function, group ) );
+
+	if (groups.size() > 1)
+		function( 0 );
+
+	for (std::thread& worker : workers)
+		worker.join();
 }
 
-template <class character_t>
-bool Trie<character_t>::add_word( const character_t* word, const character_t* translation)
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::load_segments_parallel( unsigned threads)
 {
-	if ( this->entry_count == std::numeric_limits<uint64_t>::max() ||
-		 (strlen( word, this->end_of_string) == (std::numeric_limits<uint8_t>::max()-1)) ||
-		 (strlen( translation, this->end_of_string) == (std::numeric_limits<uint16_t>::max()-1)) )
-		return false;
+	std::vector<file_segment> segments;
+	segments.swap( this->pending_segments );
+	this->pending_count = 0;
 
-	// read existing Trie until you reach unsaved part of the word
-	TrieNode<character_t>* current = this->head;
-	TrieNode<character_t>* previous = NULL;
-	uint8_t current_word_position = 0;
-	while (current != NULL)
+	std::vector<size_t> groups = segment_groups( segments, threads);
+
+	// every group is read in its own Trie, without indexes
+	std::vector< std::unique_ptr< Trie<character_t, value_t, alphabet_t, options_t> > > parts;
+	for (size_t i=0; i + 1 < groups.size(); i++)
+		parts.push_back( std::unique_ptr< Trie<character_t, value_t, alphabet_t, options_t> >( new Trie<character_t, value_t, alphabet_t, options_t>( this->end_of_string ) ) );
+
+	// exceptions can't leave a thread, a group keeps its own and the calling thread throws it again
+	std::vector<std::exception_ptr> errors( parts.size() );
+	for_each_group( groups, [&]( size_t group)
 	{
-		previous = current;
-		current = current->get_node_if_possible( word[current_word_position] );
+		FILE* file = fopen( this->dictionary_name.c_str(), "rb");
+		if (file == NULL)
+		{
+			errors[group] = std::make_exception_ptr( ErrorReadingDictionaryException( this->dictionary_name, "Can't read a segment of the file") );
+			return;
+		}
 
-		++current_word_position;
-	}
-	current_word_position--;
+		try
+		{
+			parts[group]->dictionary_name = this->dictionary_name;
+			for (size_t i=groups[group]; i < groups[group+1]; i++)
+			{
+				if (fseek( file, (long) segments[i].offset, SEEK_SET) != 0)
+					throw ErrorReadingDictionaryException( this->dictionary_name, "Broken segment index");
+				parts[group]->read_entries( file, segments[i].count, this->pending_flags);
+			}
+		}
+		catch (...)
+		{
+			errors[group] = std::current_exception();
+		}
 
-	// start inserting TrieNodes (letters)
-	while ( word[current_word_position] != this->end_of_string )
+		fclose(file);
+	});
+
+	for (std::exception_ptr& error : errors)
+		if (error)
+			std::rethrow_exception( error );
+
+	// segments begin with different characters, merge_from moves their sub-tries as they are
+	// indexes are built once, at the end
+	// the word filter and the reverse index read with the file already have all words
+	bool suffix = (this->suffix_index != NULL);
+	delete this->suffix_index;
+	this->suffix_index = NULL;
+	std::shared_ptr<WordFilter> filter;
+	std::shared_ptr< ReverseIndex<character_t> > reverse;
+	filter.swap( this->word_filter );
+	reverse.swap( this->reverse_index );
+	bool words = (this->word_index != NULL);
+	this->word_index.reset();
+
+	for (size_t i=0; i < parts.size(); i++)
 	{
-		previous = previous->insert_letter( word[current_word_position] );
-		++current_word_position;
+		this->merge_from( *parts[i] );
+		parts[i].reset();
 	}
+	this->word_filter.swap( filter );
+	this->reverse_index.swap( reverse );
 
-	// reached the end of the given word. Check if translation already exists
-	if (previous->get_translation() != NULL)
-		return false;
+	if (suffix)
+		this->rebuild_suffix_index();
+	if (words)
+		this->rebuild_word_index();
+}
 
-	// add word with translation, increase entry_count
-	previous->set_translation( translation, this->end_of_string);
-	this->entry_count++;
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::load_word_segment( const character_t* word, uint32_t word_length)
+{
+	// the empty word is never pending
+	if ( !this->pending_segments.empty() && (word_length > 0) )
+		this->load_segment( word[0] );
+}
 
-	return true;
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::load_prefix_segments( const character_t* prefix, uint32_t prefix_length)
+{
+	if (prefix_length == 0)
+		this->prefetch();
+	else
+		this->load_word_segment( prefix, prefix_length);
 }
 
-template <class character_t>
-bool Trie<character_t>::add_word( const std::vector<character_t> word, const std::vector<character_t> translation)
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::prefetch()
 {
-	return this->add_word( word.data(), translation.data() );
+	while ( !this->pending_segments.empty() )
+		this->load_segment( this->pending_segments.back().character );
 }
 
-template <class character_t>
-bool Trie<character_t>::delete_word( const character_t* word)
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint64_t Trie<character_t, value_t, alphabet_t, options_t>::get_pending_count()
 {
-	// keep track of all the visited nodes while traversing the trie in an array of pointers
-	// they could potentially be deleted in the end
-	TrieNode<character_t>** delete_path = new TrieNode<character_t>*[ strlen( word, this->end_of_string)+1 ];
-	for (uint8_t i=0; i < strlen( word, this->end_of_string); i++)
-		delete_path[i] = NULL;
+	return this->pending_count;
+}
 
-	// read existing Trie and update the delete path until you reach unsaved part of the word
-	// for a successful deletion, we should not have an unsaved part
-	TrieNode<character_t>* current = this->head;
-	TrieNode<character_t>* previous = NULL;
-	uint8_t current_word_position = 0;
-	while (current != NULL)
-	{
-		previous = current;
-		current = current->get_node_if_possible( word[current_word_position] );
+template <class character_t, class value_t, class alphabet_t, class options_t>
+Trie<character_t, value_t, alphabet_t, options_t>::Trie( const Trie& other) : end_of_string(other.end_of_string)
+{
+	// pending segments are copied too, each Trie adds them from the file when it needs them
+	this->pending_segments = other.pending_segments;
+	this->pending_count = other.pending_count;
+	this->pending_flags = other.pending_flags;
+
+	this->entry_count = other.entry_count;
+	this->dictionary_name = other.dictionary_name;
+	this->lazy_pruning = other.lazy_pruning;
+	this->arenas = other.arenas;
+	this->reverse_index = other.reverse_index;
+	this->suffix_index = (other.suffix_index != NULL) ? new Trie<character_t, uint8_t, alphabet_t>( *other.suffix_index ) : NULL;
+	this->word_filter = other.word_filter;
+	this->word_index = other.word_index;
+
+	this->head = TrieNode<character_t, value_t, alphabet_t, options_t>::share( other.head );
+}
 
-		delete_path[current_word_position] = previous;
+template <class character_t, class value_t, class alphabet_t, class options_t>
+Trie<character_t, value_t, alphabet_t, options_t>& Trie<character_t, value_t, alphabet_t, options_t>::operator=( const Trie& other)
+{
+	if (this->end_of_string != other.end_of_string)
+		throw ConflictingTriesException();
 
-		++current_word_position;
-	}
-	current_word_position--;
+	if (&other == this)
+		return *this;
 
-	// report an error if word given is not saved or it doesn't have a translation
-	if ( (strlen( word, this->end_of_string) != current_word_position) || previous->get_translation() == NULL)
-		return false;
+	// same as the copy constructor, pending segments of this Trie are replaced too
+	this->pending_segments = other.pending_segments;
+	this->pending_count = other.pending_count;
+	this->pending_flags = other.pending_flags;
 
-	// at this point, you will surely have a successful deletion, delete translation
-	previous->set_translation(NULL, this->end_of_string);
+	this->clear_nodes();
+	this->head = TrieNode<character_t, value_t, alphabet_t, options_t>::share( other.head );
+	this->arenas = other.arenas;
 
-	// loop through the delete path in reverse order
-	// we always refer to current node as (i-1) to have an end loop condition > 0 for uint8_t
-	for (uint8_t i=(strlen( word, this->end_of_string)); i > 0; i--)
-	{
-		/* if current node in the delete path
-			1) doesn't have children and translation (empty)
-			2) is not the head of the trie
-		   ,then delete it and inform its parent about the deletion
-		   ,otherwise, end of deletion process */
+	this->entry_count = other.entry_count;
+	this->dictionary_name = other.dictionary_name;
+	this->lazy_pruning = other.lazy_pruning;
 
-		if ( (delete_path[i-1]->is_empty()) && (delete_path[i-1] != this->head) )
-		{
-			delete delete_path[i];
-			delete_path[i-2]->set_child_null( word[i-2] );
-		}
-		else
-		{
-			break;
-		}
-	}
+	delete this->suffix_index;
+	this->reverse_index = other.reverse_index;
+	this->suffix_index = (other.suffix_index != NULL) ? new Trie<character_t, uint8_t, alphabet_t>( *other.suffix_index ) : NULL;
+	this->word_filter = other.word_filter;
+	this->word_index = other.word_index;
 
-	// decrease the entry count by 1
-	this->entry_count--;
+	return *this;
+}
 
-	// delete all saved delete path pointers
-	delete[] delete_path;
+template <class character_t, class value_t, class alphabet_t, class options_t>
+Trie<character_t, value_t, alphabet_t, options_t> Trie<character_t, value_t, alphabet_t, options_t>::snapshot()
+{
+	return Trie( *this );
+}
 
-	return true;
+template <class character_t, class value_t, class alphabet_t, class options_t>
+Trie<character_t, value_t, alphabet_t, options_t>::~Trie()
+{
+	this->clear_nodes();
+	delete this->suffix_index;
 }
 
-template <class character_t>
-bool Trie<character_t>::delete_word( const std::vector<character_t> word)
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::clear_nodes()
 {
-	return this->delete_word( word.data() );
+	//  start deleting nodes from head, recursively (TrieNodes shared with copies of the Trie stay)
+	TrieNode<character_t, value_t, alphabet_t, options_t>::destroy( this->head );
+	this->head = NULL;
+
+	this->arenas.clear();
 }
 
-template <class character_t>
-uint64_t Trie<character_t>::get_entry_count()
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::own_head()
 {
-	return this->entry_count;
+	if (!this->head->is_shared())
+		return;
+
+	TrieNode<character_t, value_t, alphabet_t, options_t>* copy = this->head->clone( this->end_of_string );
+	TrieNode<character_t, value_t, alphabet_t, options_t>::destroy( this->head );
+	this->head = copy;
 }
 
-template <class character_t>
-std::vector< std::vector<character_t> > Trie<character_t>::get_prefix_words( const character_t* word, int64_t n)
+template <class character_t, class value_t, class alphabet_t, class options_t>
+TrieNode<character_t, value_t, alphabet_t, options_t>* Trie<character_t, value_t, alphabet_t, options_t>::own_child( TrieNode<character_t, value_t, alphabet_t, options_t>* node, letter_t letter, TrieNode<character_t, value_t, alphabet_t, options_t>* child)
 {
-	// create a vector to return, this vector contains max. n words (which are also words)
-	std::vector< std::vector<character_t> > toReturn;
+	if (!child->is_shared())
+		return child;
 
-	// read existing Trie until you reach unsaved the end or the unsaved part of the word given as argument
-	// write all saved parts of the word in current_word vector
-	std::vector<character_t> current_word;
+	// the old child keeps its other parents
+	TrieNode<character_t, value_t, alphabet_t, options_t>* copy = child->clone( this->end_of_string );
+	node->replace_child( letter, copy );
+	TrieNode<character_t, value_t, alphabet_t, options_t>::destroy( child );
 
-	TrieNode<character_t>* current = this->head;
-	TrieNode<character_t>* previous = NULL;
-	uint8_t current_word_position = 0;
-	while (current != NULL)
-	{
-		current_word.push_back( word[current_word_position] );
+	return copy;
+}
 
-		previous = current;
-		current = current->get_node_if_possible( word[current_word_position] );
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::unshare_path( TrieNode<character_t, value_t, alphabet_t, options_t>** path, uint32_t depth, const character_t* word)
+{
+	this->own_head();
+	bool copied = (path[0] != this->head);
+	path[0] = this->head;
 
-		++current_word_position;
+	// the children of a copied TrieNode are all shared, so a copy usually continues down to path[depth]
+	letter_t letter;
+	for (uint32_t i=1; i <= depth; i++)
+	{
+		to_letter<alphabet_t>( word[i-1], letter);
+		TrieNode<character_t, value_t, alphabet_t, options_t>* child = this->own_child( path[i-1], letter, path[i]);
+		copied = copied || (child != path[i]);
+		path[i] = child;
 	}
 
-	if (!current_word.empty())
-		current_word.pop_back();
-
-	n--;
-	previous->get_prefix_words( toReturn, current_word, std::vector<character_t>(), n);
+	// the words of the copied TrieNodes are found in their copies from now on
+	if ( copied && (this->word_index != NULL) )
+	{
+		this->own_word_index();
+		for (uint32_t i=0; i <= depth; i++)
+			if (path[i]->has_translation())
+				this->word_index->insert( word, i, path[i]);
+	}
+}
 
-	for (auto& i : toReturn)
-		i.push_back( this->end_of_string );
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool Trie<character_t, value_t, alphabet_t, options_t>::is_empty()
+{
+	return (this->entry_count == 0) && (this->pending_count == 0);
+}
 
-	return toReturn;
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::set_lazy_pruning( bool lazy)
+{
+	this->lazy_pruning = lazy;
 }
 
-template <class character_t>
-std::vector< std::vector<character_t> > Trie<character_t>::get_prefix_words( const std::vector<character_t> word, int64_t n)
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::compact()
 {
-	return this->get_prefix_words( word.data(), n );
+	this->prefetch();
+	// copy all TrieNodes with translations in their sub-tries in a new arena, then delete the old ones
+	uint64_t arena_size = this->head->arena_size();
+	std::shared_ptr<char> arena( new char[arena_size], std::default_delete<char[]>() );
+	char* position = arena.get();
+	TrieNode<character_t, value_t, alphabet_t, options_t>* new_head = this->head->move_to_arena( position, false, this->end_of_string );
+
+	this->clear_nodes();
+	this->head = new_head;
+	this->arenas.push_back( std::make_pair( arena, arena_size ) );
+
+	if (this->suffix_index != NULL)
+		this->suffix_index->compact();
+	if (this->word_filter != NULL)
+		this->rebuild_word_filter();
+	if (this->word_index != NULL)
+		this->rebuild_word_index();
 }
 
-template <class character_t>
-void Trie<character_t>::save_changes()
+template <class character_t, class value_t, class alphabet_t, class options_t>
+TrieStats Trie<character_t, value_t, alphabet_t, options_t>::get_stats()
 {
-	if (this->dictionary_name == "")
-		throw ErrorOpeningDictionaryException("-- no dictionary name given --");
+	this->prefetch();
+	TrieStats toReturn = {};
+	toReturn.entry_count = this->entry_count;
 
-	// open dictionary file to write from scratch
-	FILE* file = fopen( this->dictionary_name.c_str(), "wb");
-	if (file == NULL)
-		throw ErrorOpeningDictionaryException(this->dictionary_name);
+	std::vector< TrieNode<character_t, value_t, alphabet_t, options_t>* > nodes( 1, this->head );
+	while (!nodes.empty())
+	{
+		TrieNode<character_t, value_t, alphabet_t, options_t>* node = nodes.back();
+		nodes.pop_back();
 
-	// write character size and total entries for this dictionary
-	uint8_t character_size = sizeof(character_t);
-	fwrite( &character_size, sizeof(uint8_t), 1, file);
+		toReturn.node_count++;
+		toReturn.node_bytes += node->get_node_bytes();
+		if (node->has_translation())
+			toReturn.translation_bytes += translation_traits::heap_size( node->get_translation(), this->end_of_string);
 
-	fwrite( &this->entry_count, sizeof(uint64_t), 1, file);
+		node->for_each_child( 0, [&]( letter_t, TrieNode<character_t, value_t, alphabet_t, options_t>* child)
+		{
+			nodes.push_back( child );
+			return false;
+		});
+	}
 
-	// start saving tuples, recursively
-	this->head->save_subtrie( std::vector<character_t>(), std::vector<character_t>(), file);
+	for (auto& arena : this->arenas)
+		toReturn.arena_bytes += arena.second;
 
-	// close dictionary file
-	fclose(file);
+	if (this->reverse_index != NULL)
+		toReturn.reverse_index_bytes = this->reverse_index->get_bytes();
+
+	if (this->suffix_index != NULL)
+	{
+		TrieStats suffix_stats = this->suffix_index->get_stats();
+		toReturn.suffix_index_bytes = sizeof(*this->suffix_index) + suffix_stats.node_bytes +
+									  suffix_stats.arena_bytes - std::min( suffix_stats.arena_bytes, suffix_stats.node_bytes);
+	}
+
+	if (this->word_filter != NULL)
+		toReturn.word_filter_bytes = this->word_filter->get_bytes();
+	if (this->word_index != NULL)
+		toReturn.word_index_bytes = this->word_index->get_bytes();
+
+	return toReturn;
 }
 
-template <class character_t>
-void Trie<character_t>::insert_from_csv( std::string filename)
+template <class character_t, class value_t, class alphabet_t, class options_t>
+TrieNode<character_t, value_t, alphabet_t, options_t>* Trie<character_t, value_t, alphabet_t, options_t>::get_child_node( TrieNode<character_t, value_t, alphabet_t, options_t>* node, character_t character)
 {
-	/* the csv file needs to have the format: word,translation
-		lines without a comma character are ignored
-		in case of multiple commas, the 1st one is chosen as a separator */
+	letter_t letter;
+	if ( !to_letter<alphabet_t>( character, letter) )
+		return NULL;
 
-	// open the csv file
-	std::ifstream cvs_file(filename);
-	if (!cvs_file.is_open())
-		throw ErrorOpeningCsvException(filename);
+	return node->get_node_if_possible( letter );
+}
 
-	// read file line-by-line
-	std::string word, translation;
-	std::string line;
-	std::vector<character_t> arg1, arg2;
-	while (std::getline(cvs_file, line))
-	{
-		auto comma_pos = line.find(",");
+template <class character_t, class value_t, class alphabet_t, class options_t>
+typename Trie<character_t, value_t, alphabet_t, options_t>::translation_result_t Trie<character_t, value_t, alphabet_t, options_t>::search_word( const character_t* word)
+{
+	return this->search_word( word, strlen( word, this->end_of_string) );
+}
 
-		// check if comma exists in the line
-		if (comma_pos != line.npos)
+template <class character_t, class value_t, class alphabet_t, class options_t>
+typename Trie<character_t, value_t, alphabet_t, options_t>::translation_result_t Trie<character_t, value_t, alphabet_t, options_t>::search_word( const character_t* word, uint32_t word_length)
+{
+	// most words that are not saved stop at the filter, before their segment is added
+	if ( (this->word_filter != NULL) && !this->word_filter->may_contain( word, word_length) )
+		return translation_traits::empty_result();
+
+	this->load_word_segment( word, word_length);
+
+	TrieNode<character_t, value_t, alphabet_t, options_t>* current = this->head;
+	if (this->word_index != NULL)
+	{
+		// the word index has the TrieNode of every saved word
+		current = this->word_index->find( word, word_length);
+	}
+	else
+	{
+		// read existing Trie until you reach the end or the unsaved part of the word
+		// for a successful search, we should not have an unsaved part
+		uint32_t current_word_position = 0;
+		while ( (current != NULL) && (current_word_position != word_length) )
 		{
-			word = line.substr( 0, comma_pos);
-			translation = line.substr( comma_pos+1, line.size()-comma_pos);
+			current = this->get_child_node( current, word[current_word_position] );
 
-			// add tuple
-			arg1.insert( arg1.end(), word.begin(), word.begin() + (word.size() + 1) );
-			arg2.insert( arg2.end(), translation.begin(), translation.begin() + (translation.size() + 1) );
-			this->add_word( arg1, arg2 );
-			arg1.clear();
-			arg2.clear();
+			++current_word_position;
 		}
 	}
 
-	// close csv file
-	cvs_file.close();
+	// report an error if word given is not saved or it doesn't have a translation
+	if ( (current == NULL) || !current->has_translation() )
+		return translation_traits::empty_result();
+
+	return translation_traits::to_result( current->get_translation(), this->end_of_string);
 }
 
-template <class character_t>
-void Trie<character_t>::delete_from_csv( std::string filename)
+template <class character_t, class value_t, class alphabet_t, class options_t>
+typename Trie<character_t, value_t, alphabet_t, options_t>::translation_result_t Trie<character_t, value_t, alphabet_t, options_t>::search_word( const std::vector<character_t> word )
 {
-	/* the csv file needs to have the format: word,translation
-		lines without a comma character are ignored
-		in case of multiple commas, the 1st one is chosen as a separator */
+	return this->search_word( word.data() );
+}
 
-	// open the csv file
-	std::ifstream cvs_file(filename);
-	if (!cvs_file.is_open())
-		throw ErrorOpeningCsvException(filename);
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool Trie<character_t, value_t, alphabet_t, options_t>::add_word( const character_t* word, translation_argument_t translation)
+{
+	return this->add_word( word, strlen( word, this->end_of_string), translation );
+}
 
-	// read file line-by-line
-	std::string word, translation;
-	std::string line;
-	std::vector<character_t> arg1;
-	while (std::getline(cvs_file, line))
-	{
-		auto comma_pos = line.find(",");
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool Trie<character_t, value_t, alphabet_t, options_t>::can_add( const character_t* word, uint32_t word_length, uint32_t translation_length)
+{
+	if ( this->entry_count == std::numeric_limits<uint64_t>::max() ||
+		 (word_length >= (uint32_t) (std::numeric_limits<uint8_t>::max()-1)) ||
+		 !translation_traits::is_valid( translation_length ) )
+		return false;
 
-		// check if comma exists in the line
-		if (comma_pos != line.npos)
-		{
-			word = line.substr( 0, comma_pos);
+	// every character of the word needs to have a letter in the alphabet
+	letter_t letter;
+	for (uint32_t i=0; i < word_length; i++)
+		if ( !to_letter<alphabet_t>( word[i], letter) )
+			return false;
 
-			// delete tuple
-			arg1.insert( arg1.end(), word.begin(), word.begin() + (word.size() + 1) );
-			this->delete_word( arg1 );
-			arg1.clear();
-		}
+	return true;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool Trie<character_t, value_t, alphabet_t, options_t>::add_from_path( TrieNode<character_t, value_t, alphabet_t, options_t>** insert_path, uint32_t depth,
+										const character_t* word, uint32_t word_length, translation_argument_t translation, uint32_t translation_length, uint32_t score)
+{
+	// read existing Trie until you reach the end or the unsaved part of the word
+	TrieNode<character_t, value_t, alphabet_t, options_t>* current = insert_path[depth];
+	TrieNode<character_t, value_t, alphabet_t, options_t>* next;
+	letter_t letter;
+	while (depth != word_length)
+	{
+		to_letter<alphabet_t>( word[depth], letter);
+		next = current->get_node_if_possible( letter );
+		if (next == NULL)
+			break;
+		current = next;
+
+		++depth;
+		insert_path[depth] = current;
+	}
+
+	// reached the end of the given word. Check if translation already exists
+	if ( (depth == word_length) && current->has_translation() )
+		return false;
+
+	// the saved part of the word changes, then start inserting TrieNodes (letters)
+	this->unshare_path( insert_path, depth, word);
+	current = insert_path[depth];
+	while (depth != word_length)
+	{
+		to_letter<alphabet_t>( word[depth], letter);
+		current = current->insert_letter( letter );
+
+		++depth;
+		insert_path[depth] = current;
+	}
+
+	// add word with translation, increase entry_count
+	current->set_translation( translation, translation_length, this->end_of_string);
+	this->entry_count++;
+
+	for (uint32_t i=0; i <= word_length; i++)
+		insert_path[i]->increase_subtree_count();
+
+	if (this->reverse_index != NULL)
+		this->reverse_index_update( word, word_length, translation, true);
+	if (this->suffix_index != NULL)
+		this->suffix_index_update( word, word_length, true);
+	if (this->word_filter != NULL)
+		this->word_filter_update( word, word_length, true);
+	if (this->word_index != NULL)
+	{
+		this->own_word_index();
+		this->word_index->insert( word, word_length, current);
+	}
+
+	// a score of 0 never changes a max. score
+	current->set_score( score );
+	if (score > 0)
+		this->update_max_scores( insert_path, word_length);
+
+	return true;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::update_max_scores( TrieNode<character_t, value_t, alphabet_t, options_t>** path, uint32_t depth)
+{
+	while ( path[depth]->update_max_score() && (depth > 0) )
+		depth--;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool Trie<character_t, value_t, alphabet_t, options_t>::add_word( const character_t* word, uint32_t word_length, translation_argument_t translation)
+{
+	return this->add_word( word, word_length, translation, 0 );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool Trie<character_t, value_t, alphabet_t, options_t>::add_word( const character_t* word, uint32_t word_length, translation_argument_t translation, uint32_t score)
+{
+	this->load_word_segment( word, word_length);
+	uint32_t translation_length = translation_traits::measure( translation, this->end_of_string);
+	if ( !this->can_add( word, word_length, translation_length) )
+		return false;
+
+	// keep track of all the visited nodes, their sub-trie counts change if the insertion succeeds
+	TrieNode<character_t, value_t, alphabet_t, options_t>* insert_path[ std::numeric_limits<uint8_t>::max() ];
+	insert_path[0] = this->head;
+
+	return this->add_from_path( insert_path, 0, word, word_length, translation, translation_length, score);
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector<bool> Trie<character_t, value_t, alphabet_t, options_t>::add_batch( const std::vector< std::vector<character_t> >& words, const std::vector<translation_container_t>& translations)
+{
+	std::vector<bool> toReturn( words.size(), false);
+
+	// words are visited in lexicographic order, same words keep the order of the batch (the first one is added)
+	std::vector<uint32_t> lengths( words.size() );
+	std::vector<size_t> order( words.size() );
+	for (size_t i=0; i < words.size(); i++)
+	{
+		lengths[i] = strlen( words[i].data(), this->end_of_string);
+		order[i] = i;
+		this->load_word_segment( words[i].data(), lengths[i]);
+	}
+
+	auto smaller = [&]( size_t a, size_t b)
+	{
+		return std::lexicographical_compare( words[a].data(), words[a].data() + lengths[a], words[b].data(), words[b].data() + lengths[b] );
+	};
+	if ( !std::is_sorted( order.begin(), order.end(), smaller) )
+		std::stable_sort( order.begin(), order.end(), smaller);
+
+	// path of the previous insertion, every word continues from its common prefix with the previous one
+	// insertions never delete TrieNodes, so the path stays valid
+	TrieNode<character_t, value_t, alphabet_t, options_t>* insert_path[ std::numeric_limits<uint8_t>::max() ];
+	insert_path[0] = this->head;
+	const character_t* previous_word = NULL;
+	uint32_t previous_length = 0;
+
+	for (size_t i : order)
+	{
+		if (i >= translations.size())
+			continue;
+
+		const character_t* word = words[i].data();
+		translation_argument_t translation = translation_traits::to_argument( translations[i] );
+		uint32_t translation_length = translation_traits::measure( translation, this->end_of_string);
+		if ( !this->can_add( word, lengths[i], translation_length) )
+			continue;
+
+		uint32_t depth = 0;
+		while ( (depth != previous_length) && (depth != lengths[i]) && (previous_word[depth] == word[depth]) )
+			depth++;
+
+		toReturn[i] = this->add_from_path( insert_path, depth, word, lengths[i], translation, translation_length, 0);
+
+		previous_word = word;
+		previous_length = lengths[i];
+	}
+
+	return toReturn;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool Trie<character_t, value_t, alphabet_t, options_t>::add_word( const std::vector<character_t> word, const translation_container_t translation)
+{
+	return this->add_word( word.data(), translation_traits::to_argument(translation) );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool Trie<character_t, value_t, alphabet_t, options_t>::delete_word( const character_t* word)
+{
+	return this->delete_word( word, strlen( word, this->end_of_string) );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool Trie<character_t, value_t, alphabet_t, options_t>::delete_word( const character_t* word, uint32_t word_length)
+{
+	this->load_word_segment( word, word_length);
+	// longer words can't be saved
+	if (word_length >= (uint32_t) (std::numeric_limits<uint8_t>::max()-1))
+		return false;
+
+	// keep track of all the visited nodes while traversing the trie in an array of pointers
+	// they could potentially be deleted in the end
+	TrieNode<character_t, value_t, alphabet_t, options_t>* delete_path[ std::numeric_limits<uint8_t>::max() ];
+
+	// read existing Trie and update the delete path until you reach the end or the unsaved part of the word
+	// for a successful deletion, we should not have an unsaved part
+	TrieNode<character_t, value_t, alphabet_t, options_t>* current = this->head;
+	uint32_t current_word_position = 0;
+	delete_path[0] = this->head;
+	while ( (current != NULL) && (current_word_position != word_length) )
+	{
+		current = this->get_child_node( current, word[current_word_position] );
+
+		++current_word_position;
+		delete_path[current_word_position] = current;
+	}
+
+	// report an error if word given is not saved or it doesn't have a translation
+	if ( (current == NULL) || !current->has_translation())
+		return false;
+
+	// at this point, you will surely have a successful deletion, delete translation
+	this->unshare_path( delete_path, word_length, word);
+	current = delete_path[word_length];
+
+	if (this->reverse_index != NULL)
+		this->reverse_index_update( word, word_length, translation_traits::view(current->get_translation()), false);
+	if (this->suffix_index != NULL)
+		this->suffix_index_update( word, word_length, false);
+	if (this->word_index != NULL)
+	{
+		this->own_word_index();
+		this->word_index->erase( word, word_length);
+	}
+
+	bool had_score = (current->get_score() > 0);
+	current->clear_translation();
+
+	for (uint32_t i=0; i <= word_length; i++)
+		delete_path[i]->decrease_subtree_count();
+
+	// loop through the delete path in reverse order (head is never deleted)
+	// with lazy pruning, emptied nodes stay in the Trie until compact is called
+	uint32_t remaining_path = word_length;
+	for (uint32_t i=word_length; (i > 0) && !this->lazy_pruning; i--)
+	{
+		/* if current node in the delete path doesn't have children and translation (empty)
+		   ,then delete it and inform its parent about the deletion
+		   ,otherwise, end of deletion process */
+
+		if (delete_path[i]->is_empty())
+		{
+			letter_t letter;
+			to_letter<alphabet_t>( word[i-1], letter);
+
+			TrieNode<character_t, value_t, alphabet_t, options_t>::destroy( delete_path[i] );
+			delete_path[i-1]->set_child_null( letter );
+			remaining_path = i-1;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	// the deleted score may have been the max. score of the remaining TrieNodes of the path
+	if (had_score)
+		this->update_max_scores( delete_path, remaining_path);
+
+	// decrease the entry count by 1
+	this->entry_count--;
+
+	if (this->word_filter != NULL)
+		this->word_filter_update( word, word_length, false);
+
+	return true;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool Trie<character_t, value_t, alphabet_t, options_t>::delete_word( const std::vector<character_t> word)
+{
+	return this->delete_word( word.data() );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint64_t Trie<character_t, value_t, alphabet_t, options_t>::delete_prefix( const character_t* prefix)
+{
+	return this->delete_prefix( prefix, strlen( prefix, this->end_of_string) );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint64_t Trie<character_t, value_t, alphabet_t, options_t>::delete_prefix( const character_t* prefix, uint32_t prefix_length)
+{
+	this->load_prefix_segments( prefix, prefix_length);
+	// longer words can't be saved
+	if (prefix_length >= (uint32_t) (std::numeric_limits<uint8_t>::max()-1))
+		return 0;
+
+	// same path tracking as delete_word
+	TrieNode<character_t, value_t, alphabet_t, options_t>* delete_path[ std::numeric_limits<uint8_t>::max() ];
+
+	TrieNode<character_t, value_t, alphabet_t, options_t>* current = this->head;
+	uint32_t current_word_position = 0;
+	delete_path[0] = this->head;
+	while ( (current != NULL) && (current_word_position != prefix_length) )
+	{
+		current = this->get_child_node( current, prefix[current_word_position] );
+
+		++current_word_position;
+		delete_path[current_word_position] = current;
+	}
+
+	// the count of the sub-trie is the number of words to delete, nothing to do if nothing is saved under the prefix
+	uint64_t deleted_words = (current != NULL) ? current->count_words() : 0;
+	if (deleted_words == 0)
+		return 0;
+	this->entry_count -= deleted_words;
+
+	// empty prefix, the whole Trie goes
+	if (prefix_length == 0)
+	{
+		this->clear_nodes();
+		this->head = new TrieNode<character_t, value_t, alphabet_t, options_t>();
+		if (this->reverse_index != NULL)
+			this->rebuild_reverse_index();
+		if (this->suffix_index != NULL)
+			this->rebuild_suffix_index();
+		if (this->word_filter != NULL)
+			this->rebuild_word_filter();
+		if (this->word_index != NULL)
+			this->rebuild_word_index();
+		return deleted_words;
+	}
+
+	if ( (this->reverse_index != NULL) || (this->suffix_index != NULL) || (this->word_index != NULL) )
+	{
+		std::vector<character_t> current_word( prefix, prefix + prefix_length );
+		this->unindex_subtrie( current, current_word);
+	}
+
+	// the sub-trie of the prefix is only detached, it is not copied even if it is shared
+	this->unshare_path( delete_path, prefix_length-1, prefix);
+
+	for (uint32_t i=0; i < prefix_length; i++)
+		delete_path[i]->decrease_subtree_count( deleted_words );
+
+	// detach the sub-trie of the prefix with a single update of its parent, then free it
+	letter_t letter;
+	to_letter<alphabet_t>( prefix[prefix_length-1], letter);
+	delete_path[prefix_length-1]->set_child_null( letter );
+	TrieNode<character_t, value_t, alphabet_t, options_t>::destroy( current );
+
+	// parents left empty are removed the same way as in delete_word
+	uint32_t remaining_path = prefix_length-1;
+	for (uint32_t i=prefix_length-1; (i > 0) && !this->lazy_pruning; i--)
+	{
+		if (delete_path[i]->is_empty())
+		{
+			to_letter<alphabet_t>( prefix[i-1], letter);
+
+			TrieNode<character_t, value_t, alphabet_t, options_t>::destroy( delete_path[i] );
+			delete_path[i-1]->set_child_null( letter );
+			remaining_path = i-1;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	this->update_max_scores( delete_path, remaining_path);
+
+	if (this->word_filter != NULL)
+		this->word_filter_update( deleted_words );
+
+	return deleted_words;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint64_t Trie<character_t, value_t, alphabet_t, options_t>::delete_prefix( const std::vector<character_t> prefix)
+{
+	return this->delete_prefix( prefix.data() );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint64_t Trie<character_t, value_t, alphabet_t, options_t>::get_entry_count()
+{
+	return this->entry_count + this->pending_count;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector< std::vector<character_t> > Trie<character_t, value_t, alphabet_t, options_t>::get_prefix_words( const character_t* word, int64_t n)
+{
+	return this->get_prefix_words( word, strlen( word, this->end_of_string), n );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector< std::vector<character_t> > Trie<character_t, value_t, alphabet_t, options_t>::get_prefix_words( const character_t* word, uint32_t word_length, int64_t n)
+{
+	this->load_prefix_segments( word, word_length);
+	// create a vector to return, this vector contains max. n words (which are also words)
+	std::vector< std::vector<character_t> > toReturn;
+
+	// read existing Trie until you reach the end or the unsaved part of the word given as argument
+	// write all saved parts of the word in current_word vector
+	std::vector<character_t> current_word;
+
+	TrieNode<character_t, value_t, alphabet_t, options_t>* current = this->head;
+	TrieNode<character_t, value_t, alphabet_t, options_t>* previous = NULL;
+	uint32_t current_word_position = 0;
+	while (current != NULL)
+	{
+		previous = current;
+		if (current_word_position == word_length)
+			break;
+
+		current = this->get_child_node( current, word[current_word_position] );
+		if (current != NULL)
+			current_word.push_back( word[current_word_position] );
+
+		++current_word_position;
+	}
+
+	n--;
+	previous->get_prefix_words( toReturn, current_word, std::vector<character_t>(), n);
+
+	for (auto& i : toReturn)
+		i.push_back( this->end_of_string );
+
+	return toReturn;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector< std::vector<character_t> > Trie<character_t, value_t, alphabet_t, options_t>::get_prefix_words( const std::vector<character_t> word, int64_t n)
+{
+	return this->get_prefix_words( word.data(), n );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool Trie<character_t, value_t, alphabet_t, options_t>::set_score( const character_t* word, uint32_t score)
+{
+	return this->set_score( word, strlen( word, this->end_of_string), score );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool Trie<character_t, value_t, alphabet_t, options_t>::set_score( const character_t* word, uint32_t word_length, uint32_t score)
+{
+	static_assert( options_t::has_scores, "set_score needs a Trie with NodeOptions scores" );
+	this->load_word_segment( word, word_length);
+	if (word_length >= (uint32_t) (std::numeric_limits<uint8_t>::max()-1))
+		return false;
+
+	// max. scores of the path change with the score
+	TrieNode<character_t, value_t, alphabet_t, options_t>* path[ std::numeric_limits<uint8_t>::max() ];
+
+	TrieNode<character_t, value_t, alphabet_t, options_t>* current = this->head;
+	uint32_t current_word_position = 0;
+	path[0] = this->head;
+	while ( (current != NULL) && (current_word_position != word_length) )
+	{
+		current = this->get_child_node( current, word[current_word_position] );
+
+		++current_word_position;
+		path[current_word_position] = current;
+	}
+
+	if ( (current == NULL) || !current->has_translation() )
+		return false;
+
+	this->unshare_path( path, word_length, word);
+	current = path[word_length];
+
+	current->set_score( score );
+	this->update_max_scores( path, word_length);
+
+	return true;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool Trie<character_t, value_t, alphabet_t, options_t>::set_score( const std::vector<character_t> word, uint32_t score)
+{
+	return this->set_score( word.data(), score );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint32_t Trie<character_t, value_t, alphabet_t, options_t>::get_score( const character_t* word)
+{
+	return this->get_score( word, strlen( word, this->end_of_string) );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint32_t Trie<character_t, value_t, alphabet_t, options_t>::get_score( const character_t* word, uint32_t word_length)
+{
+	static_assert( options_t::has_scores, "get_score needs a Trie with NodeOptions scores" );
+	this->load_word_segment( word, word_length);
+	TrieNode<character_t, value_t, alphabet_t, options_t>* current = this->head;
+	uint32_t current_word_position = 0;
+	while ( (current != NULL) && (current_word_position != word_length) )
+	{
+		current = this->get_child_node( current, word[current_word_position] );
+		++current_word_position;
+	}
+
+	return ( (current != NULL) && current->has_translation() ) ? current->get_score() : 0;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint32_t Trie<character_t, value_t, alphabet_t, options_t>::get_score( const std::vector<character_t> word)
+{
+	return this->get_score( word.data() );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector< std::pair< std::vector<character_t>, uint32_t > > Trie<character_t, value_t, alphabet_t, options_t>::top_k_completions( const character_t* prefix, uint64_t k)
+{
+	return this->top_k_completions( prefix, strlen( prefix, this->end_of_string), k );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector< std::pair< std::vector<character_t>, uint32_t > > Trie<character_t, value_t, alphabet_t, options_t>::top_k_completions( const character_t* prefix, uint32_t prefix_length, uint64_t k)
+{
+	static_assert( options_t::has_scores, "top_k_completions needs a Trie with NodeOptions scores" );
+	this->load_prefix_segments( prefix, prefix_length);
+	std::vector< std::pair< std::vector<character_t>, uint32_t > > toReturn;
+
+	TrieNode<character_t, value_t, alphabet_t, options_t>* current = this->head;
+	uint32_t current_word_position = 0;
+	while ( (current != NULL) && (current_word_position != prefix_length) )
+	{
+		current = this->get_child_node( current, prefix[current_word_position] );
+		++current_word_position;
+	}
+
+	if ( (current == NULL) || current->is_emptied() || (k == 0) )
+		return toReturn;
+
+	/* words of the queue are kept as chains of letters after the prefix (index of the previous letter, character, depth)
+		so that only the words of the results are ever built */
+	struct chain_letter
+	{
+		uint32_t previous;
+		character_t character;
+		uint32_t depth;
+	};
+	std::vector<chain_letter> letters;
+	const uint32_t no_letter = std::numeric_limits<uint32_t>::max();
+
+	// lexicographic order of two chains, a prefix goes before the longer words
+	auto chain_less = [&]( uint32_t a, uint32_t b)
+	{
+		uint32_t a_depth = (a == no_letter) ? 0 : letters[a].depth;
+		uint32_t b_depth = (b == no_letter) ? 0 : letters[b].depth;
+		bool a_shorter = (a_depth < b_depth);
+		if (a_depth != b_depth)
+		{
+			// bring both chains to the same depth, a prefix of the other is smaller
+			uint32_t& deeper = (a_shorter) ? b : a;
+			uint32_t& deeper_depth = (a_shorter) ? b_depth : a_depth;
+			uint32_t target = (a_shorter) ? a_depth : b_depth;
+			while (deeper_depth != target)
+			{
+				deeper = letters[deeper].previous;
+				deeper_depth--;
+			}
+			if (a == b)
+				return a_shorter;
+		}
+
+		// walk up to the 1st common letter, the letters right below it decide
+		while (letters[a].previous != letters[b].previous)
+		{
+			a = letters[a].previous;
+			b = letters[b].previous;
+		}
+		return letters[a].character < letters[b].character;
+	};
+
+	/* a queue item is either a sub-trie (bound = its max. score) or the word of a TrieNode (bound = its score)
+		on equal bounds, the item with the lexicographically smaller path goes first, so no word of a sub-trie can
+		overtake a smaller word with the same score */
+	struct queue_item
+	{
+		uint32_t bound;
+		TrieNode<character_t, value_t, alphabet_t, options_t>* node;
+		uint32_t word_end;
+		bool is_word;
+	};
+	auto later = [&]( const queue_item& a, const queue_item& b)
+	{
+		if (a.bound != b.bound)
+			return a.bound < b.bound;
+		if (a.word_end == b.word_end)
+			return b.is_word;
+		return chain_less( b.word_end, a.word_end );
+	};
+	std::priority_queue< queue_item, std::vector<queue_item>, decltype(later) > queue( later );
+
+	queue.push( queue_item{ current->get_max_score(), current, no_letter, false } );
+
+	std::vector<character_t> suffix;
+	while ( !queue.empty() && (toReturn.size() < k) )
+	{
+		queue_item item = queue.top();
+		queue.pop();
+
+		if (item.is_word)
+		{
+			// build the word, prefix first
+			suffix.clear();
+			for (uint32_t i = item.word_end; i != no_letter; i = letters[i].previous)
+				suffix.push_back( letters[i].character );
+
+			std::vector<character_t> word( prefix, prefix + prefix_length );
+			word.insert( word.end(), suffix.rbegin(), suffix.rend() );
+			word.push_back( this->end_of_string );
+
+			toReturn.push_back( std::make_pair( word, item.bound ) );
+			continue;
+		}
+
+		// open the sub-trie, its word and its children (with words) get in the queue
+		if (item.node->has_translation())
+			queue.push( queue_item{ item.node->get_score(), item.node, item.word_end, true } );
+
+		item.node->for_each_child( 0, [&]( letter_t letter, TrieNode<character_t, value_t, alphabet_t, options_t>* child)
+		{
+			if (!child->is_emptied())
+			{
+				uint32_t depth = (item.word_end == no_letter) ? 1 : letters[item.word_end].depth + 1;
+				letters.push_back( chain_letter{ item.word_end, alphabet_t::to_character(letter), depth } );
+				queue.push( queue_item{ child->get_max_score(), child, (uint32_t) (letters.size() - 1), false } );
+			}
+			return false;
+		});
+	}
+
+	return toReturn;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector< std::pair< std::vector<character_t>, uint32_t > > Trie<character_t, value_t, alphabet_t, options_t>::top_k_completions( const std::vector<character_t> prefix, uint64_t k)
+{
+	return this->top_k_completions( prefix.data(), k );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector< std::pair< std::vector<character_t>, uint32_t > > Trie<character_t, value_t, alphabet_t, options_t>::fuzzy_search( const character_t* word, uint32_t max_edits, int64_t n)
+{
+	return this->fuzzy_search( word, strlen( word, this->end_of_string), max_edits, n );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector< std::pair< std::vector<character_t>, uint32_t > > Trie<character_t, value_t, alphabet_t, options_t>::fuzzy_search( const character_t* word, uint32_t word_length, uint32_t max_edits, int64_t n)
+{
+	this->prefetch();
+	std::vector< std::pair< std::vector<character_t>, uint32_t > > toReturn;
+
+	// saved words have at most 253 characters, longer words are more than max_edits edits away from all of them
+	// and no saved word is more than word_length + 253 edits away, so max_edits + 1 (the mark of the band) never overflows
+	uint64_t max_saved_length = std::numeric_limits<uint8_t>::max() - 2;
+	if ((uint64_t) word_length > max_saved_length + max_edits)
+		return toReturn;
+	max_edits = (uint32_t) std::min( (uint64_t) max_edits, std::min( word_length + max_saved_length, (uint64_t) std::numeric_limits<uint32_t>::max() - 1 ) );
+
+	// a row for every depth up to 255 is enough
+	std::vector<uint32_t> rows( (uint64_t) (std::numeric_limits<uint8_t>::max() + 1) * (word_length + 1) );
+
+	// row of the head (empty word), j deletions for the first j characters of the word
+	// max_edits+1 marks the first cell after the band
+	uint32_t band_end = std::min( word_length, max_edits);
+	for (uint32_t j = 0; j <= band_end; j++)
+		rows[j] = j;
+	if (band_end < word_length)
+		rows[band_end + 1] = max_edits + 1;
+
+	std::vector<character_t> current_word;
+	current_word.reserve( std::numeric_limits<uint8_t>::max() );
+
+	int64_t count = (n < 0) ? std::numeric_limits<int64_t>::max() : n;
+	this->fuzzy_subtrie( this->head, current_word, word, word_length, max_edits, rows, count, toReturn);
+
+	return toReturn;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector< std::pair< std::vector<character_t>, uint32_t > > Trie<character_t, value_t, alphabet_t, options_t>::fuzzy_search( const std::vector<character_t> word, uint32_t max_edits, int64_t n)
+{
+	return this->fuzzy_search( word.data(), max_edits, n );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool Trie<character_t, value_t, alphabet_t, options_t>::fuzzy_subtrie( TrieNode<character_t, value_t, alphabet_t, options_t>* node, std::vector<character_t>& current_word,
+												const character_t* word, uint32_t word_length, uint32_t max_edits, std::vector<uint32_t>& rows, int64_t& count,
+												std::vector< std::pair< std::vector<character_t>, uint32_t > >& result)
+{
+	uint32_t depth = current_word.size();
+	const uint32_t* row = rows.data() + (uint64_t) depth * (word_length + 1);
+
+	// the whole word is within the band, when the lengths differ by max_edits or less
+	if ( node->has_translation() && (depth <= word_length + max_edits) && (word_length <= depth + max_edits) && (row[word_length] <= max_edits) )
+	{
+		if (count == 0)
+			return true;
+		count--;
+
+		result.push_back( std::make_pair( current_word, row[word_length] ) );
+		result.back().first.push_back( this->end_of_string );
+	}
+
+	// longer words are at least max_edits+1 edits away, and saved words have less than 255 characters
+	uint32_t child_depth = depth + 1;
+	if ( (child_depth > word_length + max_edits) || (child_depth >= std::numeric_limits<uint8_t>::max()) )
+		return false;
+
+	// band of the row of the children, cells [band_begin, band_end] can be within max_edits
+	uint32_t band_begin = (child_depth > max_edits) ? child_depth - max_edits : 0;
+	uint32_t band_end = std::min( word_length, child_depth + max_edits);
+	uint32_t* child_row = rows.data() + (uint64_t) child_depth * (word_length + 1);
+
+	return node->for_each_child( 0, [&]( letter_t letter, TrieNode<character_t, value_t, alphabet_t, options_t>* child)
+	{
+		// emptied TrieNodes of lazy pruning
+		if (child->is_emptied())
+			return false;
+
+		character_t character = alphabet_t::to_character(letter);
+
+		// cells outside of the band are max_edits+1, a single one on each side is enough for the next row
+		uint32_t best = max_edits + 1;
+		if (band_begin == 0)
+		{
+			child_row[0] = child_depth;
+			best = child_depth;
+		}
+		else
+		{
+			child_row[band_begin - 1] = max_edits + 1;
+		}
+
+		for (uint32_t j = std::max( band_begin, (uint32_t) 1); j <= band_end; j++)
+		{
+			uint32_t cell = std::min( row[j] + 1, child_row[j-1] + 1 );
+			cell = std::min( cell, row[j-1] + (uint32_t) (word[j-1] != character) );
+			child_row[j] = std::min( cell, max_edits + 1 );
+			best = std::min( best, child_row[j] );
+		}
+
+		if (band_end < word_length)
+			child_row[band_end + 1] = max_edits + 1;
+
+		// no word of the sub-trie can be within max_edits
+		if (best > max_edits)
+			return false;
+
+		current_word.push_back( character );
+		bool stop = this->fuzzy_subtrie( child, current_word, word, word_length, max_edits, rows, count, result);
+		current_word.pop_back();
+
+		return stop;
+	});
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+typename Trie<character_t, value_t, alphabet_t, options_t>::translation_result_t Trie<character_t, value_t, alphabet_t, options_t>::longest_prefix_match( const character_t* key, uint32_t& matched_length)
+{
+	return this->longest_prefix_match( key, strlen( key, this->end_of_string), matched_length );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+typename Trie<character_t, value_t, alphabet_t, options_t>::translation_result_t Trie<character_t, value_t, alphabet_t, options_t>::longest_prefix_match( const character_t* key, uint32_t key_length, uint32_t& matched_length)
+{
+	this->load_word_segment( key, key_length);
+	// descend once, remembering the deepest node with a translation
+	TrieNode<character_t, value_t, alphabet_t, options_t>* current = this->head;
+	TrieNode<character_t, value_t, alphabet_t, options_t>* last_match = NULL;
+	uint32_t current_word_position = 0;
+	while (current != NULL)
+	{
+		if (current->has_translation())
+		{
+			last_match = current;
+			matched_length = current_word_position;
+		}
+
+		if (current_word_position == key_length)
+			break;
+
+		current = this->get_child_node( current, key[current_word_position] );
+		++current_word_position;
+	}
+
+	if (last_match == NULL)
+	{
+		matched_length = 0;
+		return translation_traits::empty_result();
+	}
+
+	return translation_traits::to_result( last_match->get_translation(), this->end_of_string);
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+typename Trie<character_t, value_t, alphabet_t, options_t>::translation_result_t Trie<character_t, value_t, alphabet_t, options_t>::longest_prefix_match( const std::vector<character_t> key, uint32_t& matched_length)
+{
+	return this->longest_prefix_match( key.data(), matched_length );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector< std::vector<character_t> > Trie<character_t, value_t, alphabet_t, options_t>::get_matching_prefixes( const character_t* key)
+{
+	return this->get_matching_prefixes( key, strlen( key, this->end_of_string) );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector< std::vector<character_t> > Trie<character_t, value_t, alphabet_t, options_t>::get_matching_prefixes( const character_t* key, uint32_t key_length)
+{
+	this->load_word_segment( key, key_length);
+	std::vector< std::vector<character_t> > toReturn;
+
+	// descend once, every node with a translation on the way is a matching prefix
+	TrieNode<character_t, value_t, alphabet_t, options_t>* current = this->head;
+	uint32_t current_word_position = 0;
+	while (current != NULL)
+	{
+		if (current->has_translation())
+		{
+			toReturn.push_back( std::vector<character_t>( key, key + current_word_position ) );
+			toReturn.back().push_back( this->end_of_string );
+		}
+
+		if (current_word_position == key_length)
+			break;
+
+		current = this->get_child_node( current, key[current_word_position] );
+		++current_word_position;
+	}
+
+	return toReturn;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector< std::vector<character_t> > Trie<character_t, value_t, alphabet_t, options_t>::get_matching_prefixes( const std::vector<character_t> key)
+{
+	return this->get_matching_prefixes( key.data() );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint64_t Trie<character_t, value_t, alphabet_t, options_t>::count_prefix( const character_t* prefix)
+{
+	return this->count_prefix( prefix, strlen( prefix, this->end_of_string) );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint64_t Trie<character_t, value_t, alphabet_t, options_t>::count_prefix( const character_t* prefix, uint32_t prefix_length)
+{
+	static_assert( options_t::has_counts, "count_prefix needs a Trie with NodeOptions counts" );
+	this->load_prefix_segments( prefix, prefix_length);
+	// follow the prefix, count of the TrieNode that it reaches is the answer
+	TrieNode<character_t, value_t, alphabet_t, options_t>* current = this->head;
+	uint32_t current_word_position = 0;
+	while ( (current != NULL) && (current_word_position != prefix_length) )
+	{
+		current = this->get_child_node( current, prefix[current_word_position] );
+		++current_word_position;
+	}
+
+	return (current != NULL) ? current->count_words() : 0;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint64_t Trie<character_t, value_t, alphabet_t, options_t>::count_prefix( const std::vector<character_t> prefix)
+{
+	return this->count_prefix( prefix.data() );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint64_t Trie<character_t, value_t, alphabet_t, options_t>::rank( const character_t* word)
+{
+	return this->rank( word, strlen( word, this->end_of_string) );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint64_t Trie<character_t, value_t, alphabet_t, options_t>::rank( const character_t* word, uint32_t word_length)
+{
+	static_assert( options_t::has_counts, "rank needs a Trie with NodeOptions counts" );
+	this->prefetch();
+	uint64_t toReturn = 0;
+
+	// on every TrieNode of the path, smaller words are
+	// 1) the word of the TrieNode itself (it is a prefix of the given word)
+	// 2) the words in the sub-tries of children with smaller letters
+	TrieNode<character_t, value_t, alphabet_t, options_t>* current = this->head;
+	uint32_t current_word_position = 0;
+	while ( (current != NULL) && (current_word_position != word_length) )
+	{
+		if (current->has_translation())
+			toReturn++;
+
+		uint64_t position = alphabet_t::lower_bound( word[current_word_position] );
+		letter_t_parent smaller_children = (position == alphabet_t::size) ? current->get_children_count() : current->get_child_index( (letter_t) position );
+		for (letter_t_parent i = 0; i < smaller_children; i++)
+			toReturn += current->get_child(i)->count_words();
+
+		current = this->get_child_node( current, word[current_word_position] );
+		++current_word_position;
+	}
+
+	return toReturn;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint64_t Trie<character_t, value_t, alphabet_t, options_t>::rank( const std::vector<character_t> word)
+{
+	return this->rank( word.data() );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector<character_t> Trie<character_t, value_t, alphabet_t, options_t>::select( uint64_t k)
+{
+	static_assert( options_t::has_counts, "select needs a Trie with NodeOptions counts" );
+	this->prefetch();
+	std::vector<character_t> toReturn;
+
+	if (k >= this->entry_count)
+		return toReturn;
+
+	// skip whole sub-tries using their counts, until the k-th word is the word of the current TrieNode
+	TrieNode<character_t, value_t, alphabet_t, options_t>* current = this->head;
+	while (true)
+	{
+		if (current->has_translation())
+		{
+			if (k == 0)
+				break;
+
+			k--;
+		}
+
+		letter_t_parent child = 0;
+		while (k >= current->get_child(child)->count_words())
+			k -= current->get_child(child++)->count_words();
+
+		toReturn.push_back( alphabet_t::to_character( current->get_child_letter(child) ) );
+		current = current->get_child(child);
+	}
+
+	toReturn.push_back( this->end_of_string );
+
+	return toReturn;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+template <class function_t>
+bool Trie<character_t, value_t, alphabet_t, options_t>::match_subtrie( TrieNode<character_t, value_t, alphabet_t, options_t>* node, std::vector<character_t>& current_word,
+												Pattern<character_t>& pattern, std::vector< typename Pattern<character_t>::states_t >& states, int64_t& count, function_t& function)
+{
+	uint32_t depth = current_word.size();
+
+	if ( node->has_translation() && pattern.accepts( states[depth] ) )
+	{
+		if (count == 0)
+			return true;
+		count--;
+
+		current_word.push_back( this->end_of_string );
+		function( (const character_t*) current_word.data(), translation_traits::view(node->get_translation()) );
+		current_word.pop_back();
+	}
+
+	// saved words have less than 255 characters
+	if (depth + 1 >= std::numeric_limits<uint8_t>::max())
+		return false;
+
+	auto visit = [&]( character_t character, TrieNode<character_t, value_t, alphabet_t, options_t>* child)
+	{
+		// emptied TrieNodes of lazy pruning
+		if (child->is_emptied())
+			return false;
+
+		pattern.step( states[depth], character, states[depth+1]);
+		if (states[depth+1].empty())
+			return false;
+
+		current_word.push_back( character );
+		bool stop = this->match_subtrie( child, current_word, pattern, states, count, function);
+		current_word.pop_back();
+
+		return stop;
+	};
+
+	// only literals can follow, look their children up instead of scanning all children
+	std::vector<character_t> literals;
+	if ( pattern.only_literals( states[depth], literals) )
+	{
+		for (character_t character : literals)
+		{
+			TrieNode<character_t, value_t, alphabet_t, options_t>* child = this->get_child_node( node, character );
+			if ( (child != NULL) && visit( character, child) )
+				return true;
+		}
+		return false;
+	}
+
+	return node->for_each_child( 0, [&]( letter_t letter, TrieNode<character_t, value_t, alphabet_t, options_t>* child)
+	{
+		return visit( alphabet_t::to_character(letter), child);
+	});
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+template <class function_t>
+uint64_t Trie<character_t, value_t, alphabet_t, options_t>::for_each_match( const character_t* pattern, int64_t n, function_t function)
+{
+	return this->for_each_match( pattern, strlen( pattern, this->end_of_string), n, function );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+template <class function_t>
+uint64_t Trie<character_t, value_t, alphabet_t, options_t>::for_each_match( const character_t* pattern, uint32_t pattern_length, int64_t n, function_t function)
+{
+	this->prefetch();
+	Pattern<character_t> compiled( pattern, pattern_length);
+
+	// states of every depth, reused for all visited TrieNodes
+	std::vector< typename Pattern<character_t>::states_t > states( std::numeric_limits<uint8_t>::max() );
+	compiled.start( states[0] );
+
+	// single key buffer for all visited words
+	std::vector<character_t> current_word;
+	current_word.reserve( std::numeric_limits<uint8_t>::max() );
+
+	int64_t count = (n < 0) ? std::numeric_limits<int64_t>::max() : n;
+	this->match_subtrie( this->head, current_word, compiled, states, count, function);
+
+	return ((n < 0) ? std::numeric_limits<int64_t>::max() : n) - count;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector< std::vector<character_t> > Trie<character_t, value_t, alphabet_t, options_t>::get_pattern_words( const character_t* pattern, int64_t n)
+{
+	std::vector< std::vector<character_t> > toReturn;
+
+	this->for_each_match( pattern, n, [&]( const character_t* word, translation_argument_t)
+	{
+		toReturn.push_back( std::vector<character_t>( word, word + strlen(word, this->end_of_string) + 1 ) );
+	});
+
+	return toReturn;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector< std::vector<character_t> > Trie<character_t, value_t, alphabet_t, options_t>::get_pattern_words( const std::vector<character_t> pattern, int64_t n)
+{
+	return this->get_pattern_words( pattern.data(), n );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+template <class function_t>
+bool Trie<character_t, value_t, alphabet_t, options_t>::range_subtrie( TrieNode<character_t, value_t, alphabet_t, options_t>* node, std::vector<character_t>& current_word,
+												const character_t* lo, const character_t* hi, int64_t& count, function_t& function)
+{
+	uint32_t depth = current_word.size();
+
+	// the word of this node is hi, so this node and all words after it are out of the range
+	if ( (hi != NULL) && (hi[depth] == this->end_of_string) )
+		return true;
+
+	// the word of this node is in the range, unless it is a proper prefix of lo
+	if ( ((lo == NULL) || (lo[depth] == this->end_of_string)) && node->has_translation() )
+	{
+		if (count == 0)
+			return true;
+		count--;
+
+		current_word.push_back( this->end_of_string );
+		function( (const character_t*) current_word.data(), translation_traits::view(node->get_translation()) );
+		current_word.pop_back();
+	}
+
+	// position of the lo (hi) character among the letters, and whether the alphabet contains it
+	bool lo_active = (lo != NULL) && (lo[depth] != this->end_of_string);
+	uint64_t lo_position = (lo_active) ? alphabet_t::lower_bound( lo[depth] ) : 0;
+	bool lo_contained = lo_active && (lo_position != alphabet_t::size) && (alphabet_t::to_character( (letter_t) lo_position ) == lo[depth]);
+	uint64_t hi_position = (hi != NULL) ? alphabet_t::lower_bound( hi[depth] ) : 0;
+	bool hi_contained = (hi != NULL) && (hi_position != alphabet_t::size) && (alphabet_t::to_character( (letter_t) hi_position ) == hi[depth]);
+
+	// on the path of lo, start from the first child that is not smaller than lo
+	letter_t_parent first_child = 0;
+	if (lo_active)
+		first_child = (lo_position == alphabet_t::size) ? node->get_children_count() : node->get_child_index( (letter_t) lo_position );
+
+	return node->for_each_child( first_child, [&]( letter_t letter, TrieNode<character_t, value_t, alphabet_t, options_t>* child)
+	{
+		// on the path of hi, children with bigger letters are out of the range
+		if ( (hi != NULL) && ( (letter > hi_position) || (letter == hi_position && !hi_contained) ) )
+			return true;
+
+		current_word.push_back( alphabet_t::to_character(letter) );
+		bool stop = this->range_subtrie( child, current_word,
+										 (lo_contained && letter == lo_position) ? lo : NULL,
+										 (hi_contained && letter == hi_position) ? hi : NULL,
+										 count, function);
+		current_word.pop_back();
+
+		return stop;
+	});
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+template <class function_t>
+uint64_t Trie<character_t, value_t, alphabet_t, options_t>::for_each_in_range( const character_t* lo, const character_t* hi, int64_t n, function_t function)
+{
+	this->prefetch();
+	// single key buffer for all visited words
+	std::vector<character_t> current_word;
+	current_word.reserve( std::numeric_limits<uint8_t>::max() );
+
+	int64_t count = (n < 0) ? std::numeric_limits<int64_t>::max() : n;
+	this->range_subtrie( this->head, current_word, lo, hi, count, function);
+
+	return ((n < 0) ? std::numeric_limits<int64_t>::max() : n) - count;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector< std::vector<character_t> > Trie<character_t, value_t, alphabet_t, options_t>::get_range_words( const character_t* lo, const character_t* hi, int64_t n)
+{
+	std::vector< std::vector<character_t> > toReturn;
+
+	this->for_each_in_range( lo, hi, n, [&]( const character_t* word, translation_argument_t)
+	{
+		toReturn.push_back( std::vector<character_t>( word, word + strlen(word, this->end_of_string) + 1 ) );
+	});
+
+	return toReturn;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector< std::vector<character_t> > Trie<character_t, value_t, alphabet_t, options_t>::get_range_words( const std::vector<character_t> lo, const std::vector<character_t> hi, int64_t n)
+{
+	return this->get_range_words( lo.data(), hi.data(), n );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint64_t Trie<character_t, value_t, alphabet_t, options_t>::merge_subtrie( TrieNode<character_t, value_t, alphabet_t, options_t>* node, TrieNode<character_t, value_t, alphabet_t, options_t>* other_node, ConflictPolicy policy)
+{
+	uint64_t added_words = 0;
+
+	if (other_node->has_translation())
+	{
+		translation_argument_t translation = translation_traits::view( other_node->get_translation() );
+
+		if (!node->has_translation())
+		{
+			node->set_translation( translation, translation_traits::measure( translation, this->end_of_string), this->end_of_string);
+			node->set_score( other_node->get_score() );
+			added_words++;
+		}
+		else if (policy == ConflictPolicy::overwrite)
+		{
+			node->set_translation( translation, translation_traits::measure( translation, this->end_of_string), this->end_of_string);
+			node->set_score( other_node->get_score() );
+		}
+	}
+
+	// children of other_node are either shared with node as they are, or merged
+	// other_node is never changed, other copies of the other Trie may share it
+	other_node->for_each_child( 0, [&]( letter_t letter, TrieNode<character_t, value_t, alphabet_t, options_t>* other_child)
+	{
+		TrieNode<character_t, value_t, alphabet_t, options_t>* child = node->get_node_if_possible( letter );
+
+		if (child == NULL)
+		{
+			// emptied sub-tries of lazy pruning are left out
+			uint64_t moved_words = other_child->count_words();
+			if (moved_words > 0)
+			{
+				node->insert_letter( letter, TrieNode<character_t, value_t, alphabet_t, options_t>::share( other_child ) );
+				added_words += moved_words;
+			}
+		}
+		else if (child != other_child)
+		{
+			// the same TrieNode in both Tries (shared by a copy) has nothing to merge
+			child = this->own_child( node, letter, child);
+			added_words += this->merge_subtrie( child, other_child, policy);
+		}
+
+		return false;
+	});
+
+	node->increase_subtree_count( added_words );
+	node->update_max_score();
+
+	return added_words;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint64_t Trie<character_t, value_t, alphabet_t, options_t>::merge_from( Trie& other, ConflictPolicy policy)
+{
+	if (this->end_of_string != other.end_of_string)
+		throw ConflictingTriesException();
+
+	this->prefetch();
+	other.prefetch();
+
+	if (&other == this)
+		return 0;
+
+	this->own_head();
+	uint64_t added_words = this->merge_subtrie( this->head, other.head, policy);
+	this->entry_count += added_words;
+
+	// TrieNodes of the other Trie that were not moved are deleted with its head
+	// moved TrieNodes may live in arenas of the other Trie, which now belong to this Trie
+	TrieNode<character_t, value_t, alphabet_t, options_t>::destroy( other.head );
+	other.head = new TrieNode<character_t, value_t, alphabet_t, options_t>();
+	other.entry_count = 0;
+
+	this->arenas.insert( this->arenas.end(), other.arenas.begin(), other.arenas.end() );
+	other.arenas.clear();
+
+	// pairs changed all over the sub-tries, both indexes are built again
+	if (this->reverse_index != NULL)
+		this->rebuild_reverse_index();
+	if (other.reverse_index != NULL)
+		other.rebuild_reverse_index();
+	if (this->suffix_index != NULL)
+		this->rebuild_suffix_index();
+	if (other.suffix_index != NULL)
+		other.rebuild_suffix_index();
+	if (this->word_filter != NULL)
+		this->rebuild_word_filter();
+	if (other.word_filter != NULL)
+		other.rebuild_word_filter();
+	if (this->word_index != NULL)
+		this->rebuild_word_index();
+	if (other.word_index != NULL)
+		other.rebuild_word_index();
+
+	return added_words;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::diff_subtrie( TrieNode<character_t, value_t, alphabet_t, options_t>* node, TrieNode<character_t, value_t, alphabet_t, options_t>* other_node,
+												std::vector<character_t>& current_word, TrieDiff<character_t>& result)
+{
+	// sub-trie saved in just one of the Tries, all its words are added or removed
+	if ( (node == NULL) || (other_node == NULL) )
+	{
+		std::vector< std::vector<character_t> >& words = (node == NULL) ? result.added : result.removed;
+
+		// current_word includes the end_of_string while function is called
+		int64_t count = std::numeric_limits<int64_t>::max();
+		auto function = [&]( const character_t*, translation_argument_t)
+		{
+			words.push_back( current_word );
+		};
+		this->range_subtrie( (node == NULL) ? other_node : node, current_word, NULL, NULL, count, function);
+
+		return;
+	}
+
+	// a TrieNode shared by both Tries (copies of each other) has the same sub-trie
+	if (node == other_node)
+		return;
+
+	// word of the TrieNodes
+	if (node->has_translation() || other_node->has_translation())
+	{
+		current_word.push_back( this->end_of_string );
+
+		if (!node->has_translation())
+			result.added.push_back( current_word );
+		else if (!other_node->has_translation())
+			result.removed.push_back( current_word );
+		else if ( !translation_traits::equal( node->get_translation(), other_node->get_translation(), this->end_of_string) )
+			result.changed.push_back( current_word );
+
+		current_word.pop_back();
+	}
+
+	// visit the children of both TrieNodes in the order of their letters
+	letter_t_parent children_count = node->get_children_count();
+	letter_t_parent next_child = 0;
+	auto visit = [&]( TrieNode<character_t, value_t, alphabet_t, options_t>* child, TrieNode<character_t, value_t, alphabet_t, options_t>* other_child, letter_t letter)
+	{
+		current_word.push_back( alphabet_t::to_character(letter) );
+		this->diff_subtrie( child, other_child, current_word, result);
+		current_word.pop_back();
+	};
+
+	other_node->for_each_child( 0, [&]( letter_t other_letter, TrieNode<character_t, value_t, alphabet_t, options_t>* other_child)
+	{
+		// children of node with smaller letters
+		while ( (next_child < children_count) && (node->get_child_letter(next_child) < other_letter) )
+		{
+			visit( node->get_child(next_child), NULL, node->get_child_letter(next_child) );
+			next_child++;
+		}
+
+		if ( (next_child < children_count) && (node->get_child_letter(next_child) == other_letter) )
+			visit( node->get_child(next_child++), other_child, other_letter );
+		else
+			visit( NULL, other_child, other_letter );
+
+		return false;
+	});
+
+	for ( ; next_child < children_count; next_child++)
+		visit( node->get_child(next_child), NULL, node->get_child_letter(next_child) );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+TrieDiff<character_t> Trie<character_t, value_t, alphabet_t, options_t>::diff( Trie& other)
+{
+	if (this->end_of_string != other.end_of_string)
+		throw ConflictingTriesException();
+
+	this->prefetch();
+	other.prefetch();
+
+	TrieDiff<character_t> toReturn;
+
+	std::vector<character_t> current_word;
+	current_word.reserve( std::numeric_limits<uint8_t>::max() );
+	this->diff_subtrie( this->head, other.head, current_word, toReturn);
+
+	return toReturn;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint64_t Trie<character_t, value_t, alphabet_t, options_t>::intersect_subtrie( TrieNode<character_t, value_t, alphabet_t, options_t>* node, TrieNode<character_t, value_t, alphabet_t, options_t>* other_node)
+{
+	uint64_t deleted_words = 0;
+
+	if (node->has_translation() && !other_node->has_translation())
+	{
+		node->clear_translation();
+		deleted_words++;
+	}
+
+	// children without a common path in the other Trie, or left without words, are deleted
+	// the rest of them are kept, and the children of node get rebuilt once
+	std::vector<letter_t> kept_letters;
+	std::vector< TrieNode<character_t, value_t, alphabet_t, options_t>* > kept_children;
+	bool found_deleted = false;
+
+	node->for_each_child( 0, [&]( letter_t letter, TrieNode<character_t, value_t, alphabet_t, options_t>* child)
+	{
+		TrieNode<character_t, value_t, alphabet_t, options_t>* other_child = other_node->get_node_if_possible( letter );
+
+		// a TrieNode shared by both Tries (copies of each other) is kept as it is
+		if (other_child == NULL)
+		{
+			deleted_words += child->count_words();
+		}
+		else if (child != other_child)
+		{
+			child = this->own_child( node, letter, child);
+			deleted_words += this->intersect_subtrie( child, other_child);
+		}
+
+		if ( (other_child == NULL) || child->is_emptied() )
+		{
+			TrieNode<character_t, value_t, alphabet_t, options_t>::destroy( child );
+			found_deleted = true;
+		}
+		else
+		{
+			kept_letters.push_back( letter );
+			kept_children.push_back( child );
+		}
+
+		return false;
+	});
+
+	if (found_deleted)
+		node->set_children( kept_letters.data(), kept_children.data(), kept_children.size() );
+
+	node->decrease_subtree_count( deleted_words );
+	node->update_max_score();
+
+	return deleted_words;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint64_t Trie<character_t, value_t, alphabet_t, options_t>::intersect( Trie& other)
+{
+	if (this->end_of_string != other.end_of_string)
+		throw ConflictingTriesException();
+
+	this->prefetch();
+	other.prefetch();
+
+	if (this->head == other.head)
+		return 0;
+
+	this->own_head();
+	uint64_t deleted_words = this->intersect_subtrie( this->head, other.head);
+	this->entry_count -= deleted_words;
+
+	if ( (this->reverse_index != NULL) && (deleted_words > 0) )
+		this->rebuild_reverse_index();
+	if ( (this->suffix_index != NULL) && (deleted_words > 0) )
+		this->rebuild_suffix_index();
+	if (this->word_filter != NULL)
+		this->word_filter_update( deleted_words );
+	// intersect_subtrie copies shared TrieNodes even if it deletes nothing
+	if (this->word_index != NULL)
+		this->rebuild_word_index();
+
+	return deleted_words;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::reverse_index_update( const character_t* word, uint32_t word_length, const character_t* translation, bool add)
+{
+	// copies of the Trie keep the index as it was
+	if (this->reverse_index.use_count() > 1)
+		this->reverse_index = std::make_shared< ReverseIndex<character_t> >( *this->reverse_index );
+
+	uint32_t translation_length = strlen( translation, this->end_of_string);
+	if (add)
+		this->reverse_index->insert( translation, translation_length, word, word_length);
+	else
+		this->reverse_index->erase( translation, translation_length, word, word_length);
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+template <class other_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::reverse_index_update( const character_t*, uint32_t, const other_t&, bool)
+{
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::suffix_index_update( const character_t* word, uint32_t word_length, bool add)
+{
+	character_t key[ std::numeric_limits<uint8_t>::max() ];
+	std::reverse_copy( word, word + word_length, key);
+
+	if (add)
+		this->suffix_index->add_word( key, word_length, 0);
+	else
+		this->suffix_index->delete_word( key, word_length);
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+template <class function_t>
+bool Trie<character_t, value_t, alphabet_t, options_t>::pairs_subtrie( TrieNode<character_t, value_t, alphabet_t, options_t>* node, std::vector<character_t>& current_word, function_t& function)
+{
+	if ( node->has_translation() && !function( (const character_t*) current_word.data(), (uint32_t) current_word.size(), translation_traits::view(node->get_translation()) ) )
+		return false;
+
+	return !node->for_each_child( 0, [&]( letter_t letter, TrieNode<character_t, value_t, alphabet_t, options_t>* child)
+	{
+		current_word.push_back( alphabet_t::to_character(letter) );
+		bool go_on = this->pairs_subtrie( child, current_word, function);
+		current_word.pop_back();
+
+		return !go_on;
+	});
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::unindex_subtrie( TrieNode<character_t, value_t, alphabet_t, options_t>* node, std::vector<character_t>& current_word)
+{
+	auto unindex = [&]( const character_t* word, uint32_t word_length, translation_argument_t translation)
+	{
+		if (this->reverse_index != NULL)
+			this->reverse_index_update( word, word_length, translation, false);
+		if (this->suffix_index != NULL)
+			this->suffix_index_update( word, word_length, false);
+		if (this->word_index != NULL)
+			this->word_index->erase( word, word_length);
+		return true;
+	};
+	if (this->word_index != NULL)
+		this->own_word_index();
+	this->pairs_subtrie( node, current_word, unindex);
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::rebuild_reverse_index()
+{
+	// a new index, copies of the Trie keep the old one
+	this->reverse_index = std::make_shared< ReverseIndex<character_t> >();
+
+	std::vector<character_t> current_word;
+	auto index = [&]( const character_t* word, uint32_t word_length, translation_argument_t translation)
+	{
+		this->reverse_index_update( word, word_length, translation, true);
+		return true;
+	};
+	this->pairs_subtrie( this->head, current_word, index);
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::rebuild_suffix_index()
+{
+	delete this->suffix_index;
+	this->suffix_index = new Trie<character_t, uint8_t, alphabet_t>( this->end_of_string );
+
+	std::vector<character_t> current_word;
+	auto index = [&]( const character_t* word, uint32_t word_length, translation_argument_t)
+	{
+		this->suffix_index_update( word, word_length, true);
+		return true;
+	};
+	this->pairs_subtrie( this->head, current_word, index);
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::rebuild_word_filter()
+{
+	// a new filter, copies of the Trie keep the old one
+	this->word_filter = std::make_shared<WordFilter>( 2 * this->entry_count );
+
+	std::vector<character_t> current_word;
+	auto index = [&]( const character_t* word, uint32_t word_length, translation_argument_t)
+	{
+		this->word_filter->add( word, word_length);
+		return true;
+	};
+	this->pairs_subtrie( this->head, current_word, index);
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::word_filter_update( const character_t* word, uint32_t word_length, bool add)
+{
+	if ( this->word_filter->needs_rebuild() && this->pending_segments.empty() )
+	{
+		// the new filter has the word already (or doesn't have it anymore)
+		this->rebuild_word_filter();
+		return;
+	}
+
+	if (this->word_filter.use_count() > 1)
+		this->word_filter = std::make_shared<WordFilter>( *this->word_filter );
+
+	if (add)
+		this->word_filter->add( word, word_length);
+	else
+		this->word_filter->remove( 1 );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::word_filter_update( uint64_t removed_words)
+{
+	if (this->word_filter.use_count() > 1)
+		this->word_filter = std::make_shared<WordFilter>( *this->word_filter );
+
+	this->word_filter->remove( removed_words );
+
+	if ( this->word_filter->needs_rebuild() && this->pending_segments.empty() )
+		this->rebuild_word_filter();
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::rebuild_word_index()
+{
+	// a new index, copies of the Trie keep the old one
+	this->word_index = std::make_shared< WordIndex< character_t, TrieNode<character_t, value_t, alphabet_t, options_t>* > >();
+
+	std::vector<character_t> current_word;
+	this->index_subtrie( this->head, current_word);
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::own_word_index()
+{
+	if (this->word_index.use_count() > 1)
+		this->word_index = std::make_shared< WordIndex< character_t, TrieNode<character_t, value_t, alphabet_t, options_t>* > >( *this->word_index );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::index_subtrie( TrieNode<character_t, value_t, alphabet_t, options_t>* node, std::vector<character_t>& current_word)
+{
+	if (node->has_translation())
+		this->word_index->insert( current_word.data(), (uint32_t) current_word.size(), node);
+
+	node->for_each_child( 0, [&]( letter_t letter, TrieNode<character_t, value_t, alphabet_t, options_t>* child)
+	{
+		current_word.push_back( alphabet_t::to_character(letter) );
+		this->index_subtrie( child, current_word);
+		current_word.pop_back();
+
+		return false;
+	});
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::enable_reverse_index()
+{
+	static_assert( std::is_same< value_t, std::vector<character_t> >::value, "reverse indexes need string translations" );
+
+	this->prefetch();
+	if (this->reverse_index == NULL)
+		this->rebuild_reverse_index();
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::disable_reverse_index()
+{
+	this->reverse_index.reset();
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool Trie<character_t, value_t, alphabet_t, options_t>::has_reverse_index()
+{
+	return this->reverse_index != NULL;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector< std::vector<character_t> > Trie<character_t, value_t, alphabet_t, options_t>::search_translation( const character_t* translation)
+{
+	static_assert( std::is_same< value_t, std::vector<character_t> >::value, "reverse searches need string translations" );
+
+	std::vector< std::vector<character_t> > toReturn;
+	uint32_t translation_length = strlen( translation, this->end_of_string);
+
+	// no index, compare the translation of every pair
+	if (this->reverse_index == NULL)
+	{
+		this->prefetch();
+		this->for_each_in_range( NULL, NULL, -1, [&]( const character_t* word, translation_argument_t current_translation)
+		{
+			if (strcmp( translation, current_translation, this->end_of_string) == 0)
+				toReturn.push_back( std::vector<character_t>( word, word + strlen(word, this->end_of_string) + 1 ) );
+		});
+		return toReturn;
+	}
+
+	// the index keeps the words of pending segments too
+	const std::vector< std::vector<character_t> >* words = this->reverse_index->find( translation, translation_length);
+	if (words == NULL)
+		return toReturn;
+
+	toReturn.reserve( words->size() );
+	for (const std::vector<character_t>& word : *words)
+	{
+		toReturn.push_back( word );
+		toReturn.back().push_back( this->end_of_string );
+	}
+
+	return toReturn;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector< std::vector<character_t> > Trie<character_t, value_t, alphabet_t, options_t>::search_translation( const std::vector<character_t> translation)
+{
+	return this->search_translation( translation.data() );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::enable_suffix_index()
+{
+	this->prefetch();
+	if (this->suffix_index == NULL)
+		this->rebuild_suffix_index();
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::disable_suffix_index()
+{
+	delete this->suffix_index;
+	this->suffix_index = NULL;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool Trie<character_t, value_t, alphabet_t, options_t>::has_suffix_index()
+{
+	return this->suffix_index != NULL;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::enable_word_filter()
+{
+	this->prefetch();
+	if (this->word_filter == NULL)
+		this->rebuild_word_filter();
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::disable_word_filter()
+{
+	this->word_filter.reset();
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool Trie<character_t, value_t, alphabet_t, options_t>::has_word_filter()
+{
+	return this->word_filter != NULL;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::enable_word_index()
+{
+	this->prefetch();
+	if (this->word_index == NULL)
+		this->rebuild_word_index();
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::disable_word_index()
+{
+	this->word_index.reset();
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool Trie<character_t, value_t, alphabet_t, options_t>::has_word_index()
+{
+	return this->word_index != NULL;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector< std::vector<character_t> > Trie<character_t, value_t, alphabet_t, options_t>::get_suffix_words( const character_t* suffix, int64_t n)
+{
+	return this->get_suffix_words( suffix, strlen( suffix, this->end_of_string), n );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector< std::vector<character_t> > Trie<character_t, value_t, alphabet_t, options_t>::get_suffix_words( const character_t* suffix, uint32_t suffix_length, int64_t n)
+{
+	this->prefetch();
+	std::vector< std::vector<character_t> > toReturn;
+	if (n == 0)
+		return toReturn;
+
+	if (this->suffix_index != NULL)
+	{
+		// descend the suffix backwards, the sub-trie below keeps the beginnings of the words (backwards)
+		TrieNode<character_t, uint8_t, alphabet_t>* current = this->suffix_index->head;
+		for (uint32_t i = suffix_length; (current != NULL) && (i > 0); i--)
+			current = this->suffix_index->get_child_node( current, suffix[i-1] );
+
+		if (current == NULL)
+			return toReturn;
+
+		n--;
+		current->get_prefix_words( toReturn, std::vector<character_t>(), std::vector<character_t>(), n);
+
+		for (auto& i : toReturn)
+		{
+			std::reverse( i.begin(), i.end() );
+			i.insert( i.end(), suffix, suffix + suffix_length );
+		}
+	}
+	else
+	{
+		// no index, check the end of every word
+		std::vector<character_t> current_word;
+		auto check = [&]( const character_t* word, uint32_t word_length, translation_argument_t)
+		{
+			if ( (word_length >= suffix_length) && std::equal( suffix, suffix + suffix_length, word + (word_length - suffix_length)) )
+				toReturn.push_back( std::vector<character_t>( word, word + word_length ) );
+			return true;
+		};
+		this->pairs_subtrie( this->head, current_word, check);
+
+		// same order as the index
+		std::sort( toReturn.begin(), toReturn.end(), []( const std::vector<character_t>& a, const std::vector<character_t>& b)
+		{
+			return std::lexicographical_compare( a.rbegin(), a.rend(), b.rbegin(), b.rend() );
+		});
+		if ( (n > 0) && ((uint64_t) n < toReturn.size()) )
+			toReturn.resize( n );
+	}
+
+	for (auto& i : toReturn)
+		i.push_back( this->end_of_string );
+
+	return toReturn;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+std::vector< std::vector<character_t> > Trie<character_t, value_t, alphabet_t, options_t>::get_suffix_words( const std::vector<character_t> suffix, int64_t n)
+{
+	return this->get_suffix_words( suffix.data(), n );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::save_changes()
+{
+	this->save_changes( 1 );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void Trie<character_t, value_t, alphabet_t, options_t>::save_changes( unsigned threads)
+{
+	this->prefetch();
+	if (this->dictionary_name == "")
+		throw ErrorOpeningDictionaryException("-- no dictionary name given --");
+
+	// open dictionary file to write from scratch
+	FILE* file = fopen( this->dictionary_name.c_str(), "wb");
+	if (file == NULL)
+		throw ErrorOpeningDictionaryException(this->dictionary_name);
+
+	// write character size and total entries for this dictionary
+	// scores are saved only if there is any, files without them keep the simple header
+	bool save_scores = (this->head->get_max_score() > 0);
+	uint8_t flags = (save_scores ? FILE_SCORES : 0) | ((this->reverse_index != NULL) ? FILE_REVERSE_INDEX : 0) |
+					((this->suffix_index != NULL) ? FILE_SUFFIX_INDEX : 0) | ((this->word_filter != NULL) ? FILE_WORD_FILTER : 0) |
+					((this->word_index != NULL) ? FILE_WORD_INDEX : 0);
+	uint8_t character_size = sizeof(character_t);
+	if (flags != 0)
+	{
+		character_size |= FILE_EXTENDED_HEADER;
+		fwrite( &character_size, sizeof(uint8_t), 1, file);
+		fwrite( &flags, sizeof(uint8_t), 1, file);
 	}
+	else
+	{
+		fwrite( &character_size, sizeof(uint8_t), 1, file);
+	}
+
+	fwrite( &this->entry_count, sizeof(uint64_t), 1, file);
+
+	// start saving tuples, the empty word first and then the sub-trie of every child of head (a segment), recursively
+	std::vector<character_t> current_word;
+	this->head->save_pair( current_word, file, this->end_of_string, save_scores);
+
+	std::vector<file_segment> segments;
+	std::vector< TrieNode<character_t, value_t, alphabet_t, options_t>* > segment_nodes;
+	this->head->for_each_child( 0, [&]( letter_t letter, TrieNode<character_t, value_t, alphabet_t, options_t>* child)
+	{
+		uint64_t count = child->count_words();
+		if (count > 0)
+		{
+			file_segment segment = { alphabet_t::to_character(letter), 0, count };
+			segments.push_back( segment );
+			segment_nodes.push_back( child );
+		}
+		return false;
+	});
+
+	std::vector<size_t> groups = segment_groups( segments, threads);
+	if (groups.size() <= 2)
+	{
+		for (size_t i=0; i < segments.size(); i++)
+		{
+			segments[i].offset = ftell(file);
+			segment_nodes[i]->save_subtrie( current_word, std::vector<character_t>( 1, segments[i].character ), file, this->end_of_string, save_scores);
+		}
+	}
+	else
+	{
+		// positions of all segments
+		std::vector<uint64_t> sizes( segments.size() );
+		for_each_group( groups, [&]( size_t group)
+		{
+			for (size_t i=groups[group]; i < groups[group+1]; i++)
+				sizes[i] = segment_nodes[i]->saved_size( 1, this->end_of_string, save_scores);
+		});
+
+		uint64_t position = ftell(file);
+		for (size_t i=0; i < segments.size(); i++)
+		{
+			segments[i].offset = position;
+			position += sizes[i];
+		}
+		fflush(file);
+
+		// every group writes its segments with its own handle of the file, the TrieNodes are only read
+		std::vector<char> failed( groups.size(), 0 );
+		for_each_group( groups, [&]( size_t group)
+		{
+			FILE* group_file = fopen( this->dictionary_name.c_str(), "r+b");
+			if ( (group_file == NULL) || (fseek( group_file, (long) segments[groups[group]].offset, SEEK_SET) != 0) )
+			{
+				failed[group] = 1;
+				if (group_file != NULL)
+					fclose(group_file);
+				return;
+			}
+
+			for (size_t i=groups[group]; i < groups[group+1]; i++)
+				segment_nodes[i]->save_subtrie( std::vector<character_t>(), std::vector<character_t>( 1, segments[i].character ), group_file, this->end_of_string, save_scores);
+			fclose(group_file);
+		});
+
+		if (std::find( failed.begin(), failed.end(), 1) != failed.end())
+		{
+			fclose(file);
+			throw ErrorOpeningDictionaryException(this->dictionary_name);
+		}
+
+		fseek( file, (long) position, SEEK_SET);
+	}
+
+	// segment index, then its position and the mark of the index
+	uint64_t index_position = ftell(file);
+	uint64_t segments_count = segments.size();
+	fwrite( &segments_count, sizeof(uint64_t), 1, file);
+	for (file_segment& segment : segments)
+	{
+		fwrite( &segment.character, sizeof(character_t), 1, file);
+		fwrite( &segment.offset, sizeof(uint64_t), 1, file);
+		fwrite( &segment.count, sizeof(uint64_t), 1, file);
+	}
+	if (this->word_filter != NULL)
+		this->word_filter->write( file );
+	if (this->reverse_index != NULL)
+		this->reverse_index->write( file );
+	uint64_t mark = FILE_SEGMENTS_MARK;
+	fwrite( &index_position, sizeof(uint64_t), 1, file);
+	fwrite( &mark, sizeof(uint64_t), 1, file);
+
+	// close dictionary file
+	fclose(file);
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool Trie<character_t, value_t, alphabet_t, options_t>::csv_field( CsvField& field, std::vector<character_t>& decoded, const character_t*& characters, uint32_t& length)
+{
+	// series of bytes are used as they are, the byte after the field belongs to the CsvReader
+	if (sizeof(character_t) == 1)
+	{
+		field.data[field.length] = (char) this->end_of_string;
+		characters = (const character_t*) field.data;
+		length = field.length;
+		return true;
+	}
+
+	// wider characters keep code points (UTF-32) or UTF-16 code units
+	decoded.clear();
+	if ( !utf8_decode( field.data, field.length, decoded) )
+		return false;
+
+	length = decoded.size();
+	decoded.push_back( this->end_of_string );
+	characters = decoded.data();
+
+	return true;
+}
 
-	// close csv file
-	cvs_file.close();
+template <class character_t, class value_t, class alphabet_t, class options_t>
+CsvStats Trie<character_t, value_t, alphabet_t, options_t>::insert_from_csv( std::string filename)
+{
+	static_assert( std::is_same< value_t, std::vector<character_t> >::value, "csv import needs string translations" );
+
+	CsvReader reader(filename);
+
+	// fields are given to add_word without copies (only decoded for characters bigger than 1 byte)
+	CsvField word, translation;
+	std::vector<character_t> decoded_word, decoded_translation;
+	const character_t* w;
+	const character_t* t;
+	uint32_t word_length, translation_length;
+	uint64_t accepted = 0, rejected = 0, invalid = 0;
+	while (reader.next( word, translation))
+	{
+		if ( !this->csv_field( word, decoded_word, w, word_length) ||
+			 !this->csv_field( translation, decoded_translation, t, translation_length) )
+			invalid++;
+		else if ( this->add_word( w, word_length, t) )
+			accepted++;
+		else
+			rejected++;
+	}
+
+	CsvStats toReturn = reader.get_stats();
+	toReturn.accepted = accepted;
+	toReturn.rejected = rejected;
+	toReturn.invalid_encoding = invalid;
+
+	return toReturn;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+CsvStats Trie<character_t, value_t, alphabet_t, options_t>::delete_from_csv( std::string filename)
+{
+	CsvReader reader(filename);
+
+	CsvField word, translation;
+	std::vector<character_t> decoded_word;
+	const character_t* w;
+	uint32_t word_length;
+	uint64_t accepted = 0, rejected = 0, invalid = 0;
+	while (reader.next( word, translation))
+	{
+		if ( !this->csv_field( word, decoded_word, w, word_length) )
+			invalid++;
+		else if ( this->delete_word( w, word_length) )
+			accepted++;
+		else
+			rejected++;
+	}
+
+	CsvStats toReturn = reader.get_stats();
+	toReturn.accepted = accepted;
+	toReturn.rejected = rejected;
+	toReturn.invalid_encoding = invalid;
+
+	return toReturn;
 }
 
 }
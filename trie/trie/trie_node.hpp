@@ -1,44 +1,70 @@
 #ifndef TRIE_TRIE_NODE_H_
 #define TRIE_TRIE_NODE_H_
 
+#include <new>
 #include <vector>
 #include <limits>
+#include <algorithm>
 #include <stdint.h>
 
 #include "trie/trie.hpp"
 #include "trie/string.hpp"
+#include "trie/alphabet.hpp"
+#include "trie/node_options.hpp"
+#include "trie/translation.hpp"
 
 namespace trie
 {
 
-template <class character_t> 
-class TrieNode
+/* options_t chooses the optional data of the TrieNode (see node_options.hpp), kept in base classes that take no memory when they are off */
+template <class character_t, class value_t = std::vector<character_t>, class alphabet_t = FullAlphabet<character_t>, class options_t = NodeOptions<> >
+class TrieNode : private SubtreeCount<options_t::has_counts>, private NodeScores<options_t::has_scores>
 {
-private:
+public:
+	/* letters of the alphabet kept in the TrieNode, dense integers [0, alphabet_t::size) (see alphabet.hpp) */
+	using letter_t = typename alphabet_t::letter_type;
+
 	// type to be used for the edge cases of having the biggest possible zeros_map
-	using character_t_parent =
-		typename std::conditional< sizeof(character_t) == 1, uint16_t,
-		typename std::conditional< sizeof(character_t) == 2, uint32_t,
-		typename std::conditional< sizeof(character_t) == 4, uint64_t,
+	using letter_t_parent =
+		typename std::conditional< sizeof(letter_t) == 1, uint16_t,
+		typename std::conditional< sizeof(letter_t) == 2, uint32_t,
+		typename std::conditional< sizeof(letter_t) == 4, uint64_t,
 		void>::type >::type >::type;
 
-	/* variable size ( 2 to ((ALPHABET_SIZE/2) * 2) * sizeof(character_t) )
+private:
+	using translation_traits = TranslationTraits<character_t, value_t>;
+	using translation_storage_t = typename translation_traits::storage_type;
+	using translation_argument_t = typename translation_traits::argument_type;
+
+	/* variable size ( 2 to ((ALPHABET_SIZE/2) * 2) * sizeof(letter_t) )
 		worst case when bits have the form of 01010101... zeros_map add 2 elements for
 		each 0 bit
-		due to this case, zeros_map may have size larger than max. value of character_t
-		e.g. size of 256 for character_t -> uint8_t
+		due to this case, zeros_map may have size larger than max. value of letter_t
+		e.g. size of 256 for letter_t -> uint8_t
 		as a result, we keep half of zeros_map size (for every pair that it keeps)
 		that way, we save memory */
-	character_t *zeros_map;
-	character_t zeros_map_half_size;
+	letter_t *zeros_map;
+	letter_t zeros_map_half_size;
+
+	/* which parts of the TrieNode live in an arena built by move_to_arena (see arena_flags)
+		they are not freed one by one, the Trie frees the whole arena at once
+		kept with references in 4 bytes after zeros_map_half_size, so that the three of them fit in 8 bytes for all character types */
+	uint32_t arena_parts : 3;
+
+	/* number of parents (or Tries, for a head) that point to the TrieNode, up to 2^29 - 1
+		more than 1 when the TrieNode is shared by copies (snapshots) of a Trie, see Trie::Trie( const Trie& )
+		shared TrieNodes never change, the Trie that changes them works on a copy of their path (see clone)
+		not atomic, different copies of a Trie can't be changed by different threads at the same time */
+	uint32_t references : 29;
 
 	/* variable size (0 to ALPHABET_SIZE*sizeof(pointer)) bytes
 		pointer usually 8 bytes
 		We don't keep its size to save space. We get the size by reading zeros_map */
 	class TrieNode **children;
 
-	/* variable size, 0 to translation_size*sizeof(character_size)+sizeof(character_size) bytes */
-	character_t *translation;
+	/* string translations: pointer to a series of characters (NULL if there is none)
+		other values: the value itself, kept inline (see translation.hpp) */
+	translation_storage_t translation;
 
 	/*
 		uint8_t  always 1 byte
@@ -46,135 +72,667 @@ private:
 		char32_t always 4 bytes
 	*/
 
+	enum arena_flags : uint8_t
+	{
+		NODE_IN_ARENA = 1,
+		ZEROS_MAP_IN_ARENA = 2,
+		CHILDREN_IN_ARENA = 4
+	};
+
+	/* TrieNode placed in an arena, with arrays that are already built */
+	TrieNode( letter_t* zeros_map, letter_t zeros_map_half_size, TrieNode** children);
+
+	/* free zeros_map (children) array, unless it lives in an arena, and set it to NULL */
+	void release_zeros_map();
+	void release_children();
+
+	/* set the translation (with its score) to a copy of the translation of another TrieNode */
+	void copy_translation( TrieNode* other, character_t end_of_string );
+
+	/* number of zeros groups of a TrieNode with children for the letters given (in increasing order)
+		and the zeros_map of that TrieNode, written in the array given */
+	static letter_t_parent count_zeros_groups( const letter_t* letters, letter_t_parent count );
+	static void fill_zeros_map( const letter_t* letters, letter_t_parent count, letter_t* zeros_map );
+
+	/* letters and children of the children with translations in their sub-tries */
+	void get_kept_children( std::vector<letter_t>& kept_letters, std::vector<TrieNode*>& kept_children );
+
 public:
 	TrieNode();
 	~TrieNode();
 
+	/* drop a reference to a TrieNode, the TrieNode is deleted with its sub-trie when no references are left
+		TrieNodes in an arena only get destructed, their memory is freed with the arena */
+	static void destroy( TrieNode* node );
+
+	/* add a reference to a TrieNode, return the TrieNode */
+	static TrieNode* share( TrieNode* node );
+
+	/* return true if more than one parent (Trie) points to the TrieNode */
+	bool is_shared();
+
+	/* return a copy of the TrieNode (with a single reference), allocated one by one
+		the children are not copied, they get one more reference (the copy) and become shared */
+	TrieNode* clone( character_t end_of_string );
+
+	/* bytes of memory needed by move_to_arena for the sub-trie of the TrieNode (without sub-tries that have no translations) */
+	uint64_t arena_size();
+
+	/* copy the sub-trie of the TrieNode in the arena starting at position, in depth-first order
+		every TrieNode is followed by its zeros_map and children arrays (exact sizes), and then by the sub-tries of its children
+		sub-tries without translations (left behind by lazy deletions) are left out
+		translations are moved, not copied, so the old sub-trie only needs to be destroyed afterwards
+		unless the sub-trie is shared (shared is true, or the TrieNode is shared), then translations are copied
+		position is moved after the copied sub-trie, return the copy of the TrieNode */
+	TrieNode* move_to_arena( char*& position, bool shared, character_t end_of_string );
+
+	/* bytes used by the TrieNode itself with its zeros_map and children arrays (translations not included) */
+	uint64_t get_node_bytes();
+
 	/* return true if TrieNode has 0 children and no translation */
 	bool is_empty();
 
-	/* return size of children array - return parent type always to catch worst case for character_t */
-	character_t_parent get_children_count();
+	/* return size of children array - return parent type always to catch worst case for letter_t */
+	letter_t_parent get_children_count();
 
 	/* manage TrieNode translation */
-	character_t* get_translation();
-	void set_translation(const character_t* translation, character_t end_of_string);
+	bool has_translation();
+	const translation_storage_t& get_translation();
+	void set_translation(translation_argument_t translation, uint32_t translation_length, character_t end_of_string);
+	void clear_translation();
+
+	/* number of translations saved in the sub-trie of the TrieNode (including its own one)
+		read from the TrieNode with NodeOptions counts, counted by visiting the sub-trie otherwise
+		has_words stops at the first translation it finds */
+	uint64_t count_words();
+	bool has_words();
+
+	/* return true if the sub-trie of the TrieNode is known to have no translations (emptied by lazy pruning), so a visit can skip it
+		with NodeOptions counts for the whole sub-trie, otherwise only for the TrieNode itself (is_empty) */
+	bool is_emptied();
+
+	/* keep the number of translations of the sub-trie up to date, kept by the Trie along the path of every insertion/deletion
+		nothing to do without NodeOptions counts */
+	void increase_subtree_count( uint64_t n = 1 );
+	void decrease_subtree_count( uint64_t n = 1 );
+
+	/* manage score of the translation and biggest score of the sub-trie, used to rank completions
+		update_max_score reads the max. scores of the children, which need to be up to date
+		return true if the max. score of the TrieNode changed
+		without NodeOptions scores, scores are always 0 and nothing changes them */
+	uint32_t get_score();
+	void set_score( uint32_t score );
+	uint32_t get_max_score();
+	bool update_max_score();
 
 	/* return a Trienode pointer following the path of the argument letter
 		return NULL if there doesn't exist one */
-	TrieNode* get_node_if_possible(const character_t letter );
+	TrieNode* get_node_if_possible(const letter_t letter );
+
+	/* children are kept in the order of their letters
+		return the index of the first child with a letter equal or bigger to the letter given as argument
+		return the letter of the child with the index given as argument
+		return the child with the index given as argument */
+	letter_t_parent get_child_index(const letter_t letter );
+	letter_t get_child_letter( letter_t_parent index );
+	TrieNode* get_child( letter_t_parent index );
+
+	/* replace the child of a letter that exists in zeros_map, the old child is not deleted, this is up to the caller */
+	void replace_child( const letter_t letter, TrieNode* child );
+
+	/* call function(letter, child) for every child, in the order of their letters, starting from the child with the index given as argument
+		stop and return true as soon as function returns true */
+	template <class function_t>
+	bool for_each_child( letter_t_parent first_index, function_t function );
+
+	/* replace all children of the TrieNode with the children given as argument, in increasing order of their letters
+		children and zeros_map get rebuilt once, with their exact sizes
+		old children are not deleted, this is up to the caller */
+	void set_children( const letter_t* letters, TrieNode** new_children, letter_t_parent count );
 
 	/* adds a new Trienode path in current Trienode, updates both zeros_map and children
 		assumes that letter given as argument will always be 0 in current zeros_map
+		the child is a new empty TrieNode, or the (already built) TrieNode given as argument
 		return a pointer to the newly inserted child */
-	TrieNode* insert_letter(const character_t letter );
+	TrieNode* insert_letter(const letter_t letter, TrieNode* child = NULL );
 
 	/* deletes a Trienode path in current Trienode, updates both zeros_map and children
 		assumes that letter given as argument will always be 1 in current zeros_map */
-	bool set_child_null(const character_t letter );
+	bool set_child_null(const letter_t letter );
+
+	/* write the word given as argument with the translation of current TrieNode in the file, if there is one */
+	void save_pair( const std::vector<character_t>& current_word, FILE* file, character_t end_of_string, bool save_scores);
+
+	/* bytes that save_subtrie writes for the sub-trie of current TrieNode, whose word has depth characters */
+	uint64_t saved_size( uint32_t depth, character_t end_of_string, bool save_scores);
 
 	/* write words with their translations of the sub-trie of current TrieNde in the file pointed by the file pointer */
-	void save_subtrie( std::vector<character_t> current_word, std::vector<character_t> letter_to_append, FILE* file);
+	void save_subtrie( std::vector<character_t> current_word, std::vector<character_t> letter_to_append, FILE* file, character_t end_of_string, bool save_scores);
 
 	/* get words that are saved in the Trie and start with given prefix (TrieNode subtrie) */
 	bool get_prefix_words( std::vector< std::vector<character_t> >& toReturn, std::vector<character_t> current_word, std::vector<character_t> letter_to_append, int64_t& count);
 };
 
-template <class character_t> 
-TrieNode<character_t>::TrieNode()
+template <class character_t, class value_t, class alphabet_t, class options_t>
+TrieNode<character_t, value_t, alphabet_t, options_t>::TrieNode()
 {
 	// 2 elements to depict a full zero group for all bits
-	this->zeros_map = new character_t[2];
+	this->zeros_map = new letter_t[2];
 	this->zeros_map[0] = 0;
-	this->zeros_map[1] = std::numeric_limits<character_t>::max();
+	this->zeros_map[1] = alphabet_t::last_letter();
 	this->zeros_map_half_size = 1;
 
 	// no children in the TrieNode
 	this->children = NULL;
 
 	// no translation in the TrieNode
-	this->translation = NULL;
+	translation_traits::init( this->translation );
+
+	// allocated one by one
+	this->arena_parts = 0;
+	this->references = 1;
 }
 
-template <class character_t> 
-TrieNode<character_t>::~TrieNode()
+template <class character_t, class value_t, class alphabet_t, class options_t>
+TrieNode<character_t, value_t, alphabet_t, options_t>::TrieNode( letter_t* zeros_map, letter_t zeros_map_half_size, TrieNode** children)
+{
+	this->zeros_map = zeros_map;
+	this->zeros_map_half_size = zeros_map_half_size;
+	this->children = children;
+
+	translation_traits::init( this->translation );
+
+	this->arena_parts = NODE_IN_ARENA | ZEROS_MAP_IN_ARENA | CHILDREN_IN_ARENA;
+	this->references = 1;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+TrieNode<character_t, value_t, alphabet_t, options_t>::~TrieNode()
 {
 	// first, destruct all children of current node
 	// loop through all possile letters
 	// if current letter enters a zeros group, shift to end of the zeros group
-	character_t_parent children_count = this->get_children_count();
-	for (character_t_parent child = 0; child < children_count; child++)
+	letter_t_parent children_count = this->get_children_count();
+	for (letter_t_parent child = 0; child < children_count; child++)
 	{
-		delete this->children[child];
+		TrieNode::destroy( this->children[child] );
 	}
 
 	// all children deleted, so delete current TrieNode
-	delete[] this->translation;
-	delete[] this->zeros_map;
-	delete[] this->children;
+	translation_traits::clear( this->translation );
+	this->release_zeros_map();
+	this->release_children();
 }
 
-template <class character_t>
-bool TrieNode<character_t>::is_empty()
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void TrieNode<character_t, value_t, alphabet_t, options_t>::destroy( TrieNode* node )
 {
-	return ( (this->children == NULL) && (this->translation == NULL) );
+	// still used by other parents
+	if (--node->references > 0)
+		return;
+
+	if (node->arena_parts & NODE_IN_ARENA)
+		node->~TrieNode();
+	else
+		delete node;
 }
 
-template <class character_t> 
-typename TrieNode<character_t>::character_t_parent TrieNode<character_t>::get_children_count()
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void TrieNode<character_t, value_t, alphabet_t, options_t>::release_zeros_map()
 {
-	character_t_parent children_count = 0;
+	if ( !(this->arena_parts & ZEROS_MAP_IN_ARENA) )
+		delete[] this->zeros_map;
+
+	this->zeros_map = NULL;
+	this->arena_parts &= ~ZEROS_MAP_IN_ARENA;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void TrieNode<character_t, value_t, alphabet_t, options_t>::release_children()
+{
+	if ( !(this->arena_parts & CHILDREN_IN_ARENA) )
+		delete[] this->children;
+
+	this->children = NULL;
+	this->arena_parts &= ~CHILDREN_IN_ARENA;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+TrieNode<character_t, value_t, alphabet_t, options_t>* TrieNode<character_t, value_t, alphabet_t, options_t>::share( TrieNode* node )
+{
+	node->references++;
+	return node;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool TrieNode<character_t, value_t, alphabet_t, options_t>::is_shared()
+{
+	return this->references > 1;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void TrieNode<character_t, value_t, alphabet_t, options_t>::copy_translation( TrieNode* other, character_t end_of_string )
+{
+	if ( translation_traits::exists(other->translation) )
+	{
+		translation_argument_t t = translation_traits::view( other->translation );
+		translation_traits::set( this->translation, t, translation_traits::measure( t, end_of_string), end_of_string);
+	}
+	this->set_own_score( other->own_score() );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+TrieNode<character_t, value_t, alphabet_t, options_t>* TrieNode<character_t, value_t, alphabet_t, options_t>::clone( character_t end_of_string )
+{
+	letter_t_parent children_count = this->get_children_count();
+
+	TrieNode* toReturn = new TrieNode<character_t, value_t, alphabet_t, options_t>();
+
+	toReturn->release_zeros_map();
+	toReturn->zeros_map = new letter_t[ this->zeros_map_half_size*2 ];
+	std::copy( this->zeros_map, this->zeros_map + this->zeros_map_half_size*2, toReturn->zeros_map);
+	toReturn->zeros_map_half_size = this->zeros_map_half_size;
+
+	if (children_count > 0)
+	{
+		toReturn->children = new TrieNode<character_t, value_t, alphabet_t, options_t> *[children_count];
+		for (letter_t_parent i = 0; i < children_count; i++)
+			toReturn->children[i] = TrieNode::share( this->children[i] );
+	}
+
+	toReturn->copy_translation( this, end_of_string);
+	toReturn->copy_count( *this );
+	toReturn->set_best_score( this->best_score() );
+
+	return toReturn;
+}
+
+// every part placed in the arena starts at a multiple of the TrieNode alignment
+inline uint64_t arena_align( uint64_t bytes, uint64_t alignment)
+{
+	return (bytes + alignment - 1) / alignment * alignment;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void TrieNode<character_t, value_t, alphabet_t, options_t>::get_kept_children( std::vector<letter_t>& kept_letters, std::vector<TrieNode*>& kept_children )
+{
+	this->for_each_child( 0, [&]( letter_t letter, TrieNode* child)
+	{
+		if (child->has_words())
+		{
+			kept_letters.push_back( letter );
+			kept_children.push_back( child );
+		}
+		return false;
+	});
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint64_t TrieNode<character_t, value_t, alphabet_t, options_t>::arena_size()
+{
+	std::vector<letter_t> kept_letters;
+	std::vector<TrieNode*> kept_children;
+	this->get_kept_children( kept_letters, kept_children);
+
+	uint64_t toReturn = arena_align( sizeof(TrieNode), alignof(TrieNode) ) +
+						arena_align( (uint64_t) count_zeros_groups( kept_letters.data(), kept_letters.size() )*2*sizeof(letter_t), alignof(TrieNode) ) +
+						arena_align( (uint64_t) kept_children.size()*sizeof(TrieNode*), alignof(TrieNode) );
+
+	for (TrieNode* child : kept_children)
+		toReturn += child->arena_size();
+
+	return toReturn;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+TrieNode<character_t, value_t, alphabet_t, options_t>* TrieNode<character_t, value_t, alphabet_t, options_t>::move_to_arena( char*& position, bool shared, character_t end_of_string )
+{
+	std::vector<letter_t> kept_letters;
+	std::vector<TrieNode*> kept_children;
+	this->get_kept_children( kept_letters, kept_children);
+	letter_t_parent children_count = kept_children.size();
+	letter_t_parent zeros_groups = count_zeros_groups( kept_letters.data(), children_count );
+
+	// TrieNode, zeros_map and children arrays next to each other
+	char* node_position = position;
+	position += arena_align( sizeof(TrieNode), alignof(TrieNode) );
+
+	letter_t* new_zeros_map = (letter_t*) position;
+	fill_zeros_map( kept_letters.data(), children_count, new_zeros_map);
+	position += arena_align( (uint64_t) zeros_groups*2*sizeof(letter_t), alignof(TrieNode) );
+
+	TrieNode** new_children = (TrieNode**) position;
+	position += arena_align( (uint64_t) children_count*sizeof(TrieNode*), alignof(TrieNode) );
+
+	TrieNode* toReturn = new (node_position) TrieNode( new_zeros_map, zeros_groups, (children_count > 0) ? new_children : NULL);
+
+	// move translation, a shared one stays with the other copies of the Trie
+	shared = shared || this->is_shared();
+	if (shared)
+	{
+		toReturn->copy_translation( this, end_of_string);
+	}
+	else
+	{
+		toReturn->translation = this->translation;
+		translation_traits::init( this->translation );
+		toReturn->set_own_score( this->own_score() );
+	}
+	toReturn->copy_count( *this );
+	toReturn->set_best_score( this->best_score() );
+
+	// sub-tries of the children follow, in the order of their letters
+	for (letter_t_parent i = 0; i < children_count; i++)
+		new_children[i] = kept_children[i]->move_to_arena( position, shared, end_of_string );
+
+	return toReturn;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint64_t TrieNode<character_t, value_t, alphabet_t, options_t>::get_node_bytes()
+{
+	return sizeof(TrieNode) + (uint64_t) this->zeros_map_half_size*2*sizeof(letter_t) + (uint64_t) this->get_children_count()*sizeof(TrieNode*);
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool TrieNode<character_t, value_t, alphabet_t, options_t>::is_empty()
+{
+	return ( (this->children == NULL) && !translation_traits::exists(this->translation) );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+typename TrieNode<character_t, value_t, alphabet_t, options_t>::letter_t_parent TrieNode<character_t, value_t, alphabet_t, options_t>::get_children_count()
+{
+	// no zeros groups, every letter has a child
+	if (this->zeros_map_half_size == 0)
+		return (letter_t_parent) alphabet_t::last_letter() + 1;
+
+	letter_t_parent children_count = 0;
 
 	// ones before the 1st zeros group
 	children_count += this->zeros_map[0];
 
 	// ones between the zeros groups
-	for ( character_t i = 0; i < (this->zeros_map_half_size*2)-2; i += 2)
+	for ( letter_t i = 0; i < (this->zeros_map_half_size*2)-2; i += 2)
 		children_count += this->zeros_map[i+2] - this->zeros_map[i+1] - 1;
 
 	// ones after the last zeros group
-	children_count += std::numeric_limits<character_t>::max() - this->zeros_map[(this->zeros_map_half_size*2)-1];
+	children_count += alphabet_t::last_letter() - this->zeros_map[(this->zeros_map_half_size*2)-1];
 
 	return children_count;
 }
 
-template <class character_t>
-character_t* TrieNode<character_t>::get_translation()
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool TrieNode<character_t, value_t, alphabet_t, options_t>::has_translation()
+{
+	return translation_traits::exists( this->translation );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+const typename TrieNode<character_t, value_t, alphabet_t, options_t>::translation_storage_t& TrieNode<character_t, value_t, alphabet_t, options_t>::get_translation()
 {
 	return this->translation;
 }
 
-template <class character_t>
-void TrieNode<character_t>::set_translation( const character_t* t, character_t end_of_string)
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void TrieNode<character_t, value_t, alphabet_t, options_t>::set_translation( translation_argument_t t, uint32_t translation_length, character_t end_of_string)
+{
+	// old value (if any) is replaced
+	translation_traits::set( this->translation, t, translation_length, end_of_string);
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void TrieNode<character_t, value_t, alphabet_t, options_t>::clear_translation()
 {
-	// delete old value
-	delete[] this->translation;
+	translation_traits::clear( this->translation );
+	this->set_own_score( 0 );
+}
 
-	// set new value
-	if (t != NULL)
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint64_t TrieNode<character_t, value_t, alphabet_t, options_t>::count_words()
+{
+	if (options_t::has_counts)
+		return this->get_count();
+
+	uint64_t toReturn = translation_traits::exists(this->translation) ? 1 : 0;
+	this->for_each_child( 0, [&]( letter_t, TrieNode* child)
 	{
-		this->translation = new character_t[strlen(t) + 1];
-		strcpy( this->translation, t, end_of_string);
+		toReturn += child->count_words();
+		return false;
+	});
+
+	return toReturn;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool TrieNode<character_t, value_t, alphabet_t, options_t>::has_words()
+{
+	if (options_t::has_counts)
+		return this->get_count() > 0;
+
+	return translation_traits::exists(this->translation) || this->for_each_child( 0, []( letter_t, TrieNode* child)
+	{
+		return child->has_words();
+	});
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool TrieNode<character_t, value_t, alphabet_t, options_t>::is_emptied()
+{
+	if (options_t::has_counts)
+		return this->get_count() == 0;
+
+	return this->is_empty();
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void TrieNode<character_t, value_t, alphabet_t, options_t>::increase_subtree_count( uint64_t n )
+{
+	this->add_count( n );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void TrieNode<character_t, value_t, alphabet_t, options_t>::decrease_subtree_count( uint64_t n )
+{
+	this->remove_count( n );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint32_t TrieNode<character_t, value_t, alphabet_t, options_t>::get_score()
+{
+	return this->own_score();
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void TrieNode<character_t, value_t, alphabet_t, options_t>::set_score( uint32_t score )
+{
+	this->set_own_score( score );
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint32_t TrieNode<character_t, value_t, alphabet_t, options_t>::get_max_score()
+{
+	return this->best_score();
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool TrieNode<character_t, value_t, alphabet_t, options_t>::update_max_score()
+{
+	if (!options_t::has_scores)
+		return false;
+
+	uint32_t new_max_score = this->get_score();
+
+	letter_t_parent children_count = this->get_children_count();
+	for (letter_t_parent i = 0; i < children_count; i++)
+		if (this->children[i]->get_max_score() > new_max_score)
+			new_max_score = this->children[i]->get_max_score();
+
+	bool changed = (new_max_score != this->get_max_score());
+	this->set_best_score( new_max_score );
+
+	return changed;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+typename TrieNode<character_t, value_t, alphabet_t, options_t>::letter_t_parent TrieNode<character_t, value_t, alphabet_t, options_t>::get_child_index(const letter_t letter )
+{
+	// count the ones (children) before letter, group by group
+	letter_t_parent toReturn = 0;
+	letter_t_parent ones_group_start = 0;
+	for ( letter_t_parent i = 0; i < (letter_t_parent) this->zeros_map_half_size*2; i += 2)
+	{
+		letter_t_parent ones_group_end = (letter < this->zeros_map[i]) ? letter : this->zeros_map[i];
+		if (ones_group_end > ones_group_start)
+			toReturn += ones_group_end - ones_group_start;
+
+		// letter exists before or in current zeros group
+		if (letter <= this->zeros_map[i+1])
+			return toReturn;
+
+		ones_group_start = (letter_t_parent) this->zeros_map[i+1] + 1;
 	}
-	else
+
+	// letter exists after the last zeros group (ones group)
+	return toReturn + (letter - ones_group_start);
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+typename TrieNode<character_t, value_t, alphabet_t, options_t>::letter_t TrieNode<character_t, value_t, alphabet_t, options_t>::get_child_letter( letter_t_parent index )
+{
+	// skip whole ones groups until the one that contains index
+	letter_t_parent ones_group_start = 0;
+	for ( letter_t_parent i = 0; i < (letter_t_parent) this->zeros_map_half_size*2; i += 2)
 	{
-		this->translation = NULL;
+		letter_t_parent ones_group_size = this->zeros_map[i] - ones_group_start;
+		if (index < ones_group_size)
+			return ones_group_start + index;
+
+		index -= ones_group_size;
+		ones_group_start = (letter_t_parent) this->zeros_map[i+1] + 1;
 	}
+
+	return ones_group_start + index;
 }
 
-template <class character_t>
-TrieNode<character_t>* TrieNode<character_t>::get_node_if_possible(const character_t letter )
+template <class character_t, class value_t, class alphabet_t, class options_t>
+TrieNode<character_t, value_t, alphabet_t, options_t>* TrieNode<character_t, value_t, alphabet_t, options_t>::get_child( letter_t_parent index )
 {
-	character_t_parent children_count = 0;
+	return this->children[index];
+}
 
-	// letter exists before the 1st zeros group (ones group)
-	if (letter < this->zeros_map[0])
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void TrieNode<character_t, value_t, alphabet_t, options_t>::replace_child( const letter_t letter, TrieNode* child )
+{
+	this->children[ this->get_child_index( letter ) ] = child;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+template <class function_t>
+bool TrieNode<character_t, value_t, alphabet_t, options_t>::for_each_child( letter_t_parent first_index, function_t function )
+{
+	// walk the ones groups between the zeros groups, skipping whole groups before first_index
+	letter_t_parent alphabet_size = (letter_t_parent) alphabet_t::last_letter() + 1;
+	letter_t_parent next_child = 0;
+	letter_t_parent ones_group_start = 0;
+	for ( letter_t_parent i = 0; i <= (letter_t_parent) this->zeros_map_half_size*2; i += 2)
+	{
+		letter_t_parent ones_group_end = (i < (letter_t_parent) this->zeros_map_half_size*2) ? this->zeros_map[i] : alphabet_size;
+
+		if (next_child + (ones_group_end - ones_group_start) <= first_index)
+		{
+			next_child += ones_group_end - ones_group_start;
+		}
+		else
+		{
+			letter_t_parent letter = ones_group_start;
+			if (next_child < first_index)
+			{
+				letter += first_index - next_child;
+				next_child = first_index;
+			}
+
+			for ( ; letter < ones_group_end; letter++)
+				if ( function( (letter_t) letter, this->children[next_child++]) )
+					return true;
+		}
+
+		if (i < (letter_t_parent) this->zeros_map_half_size*2)
+			ones_group_start = (letter_t_parent) this->zeros_map[i+1] + 1;
+	}
+
+	return false;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void TrieNode<character_t, value_t, alphabet_t, options_t>::set_children( const letter_t* letters, TrieNode** new_children, letter_t_parent count )
+{
+	// children array, exact size
+	this->release_children();
+	this->children = (count > 0) ? new TrieNode<character_t, value_t, alphabet_t, options_t> *[count] : NULL;
+	for (letter_t_parent i = 0; i < count; i++)
+		this->children[i] = new_children[i];
+
+	// zeros groups are the gaps before, between and after the letters given
+	letter_t_parent zeros_groups = count_zeros_groups( letters, count );
+
+	this->release_zeros_map();
+	this->zeros_map = new letter_t[zeros_groups*2];
+	this->zeros_map_half_size = zeros_groups;
+	fill_zeros_map( letters, count, this->zeros_map);
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+typename TrieNode<character_t, value_t, alphabet_t, options_t>::letter_t_parent TrieNode<character_t, value_t, alphabet_t, options_t>::count_zeros_groups( const letter_t* letters, letter_t_parent count )
+{
+	letter_t_parent zeros_groups = 0;
+	letter_t_parent next_letter = 0;
+	for (letter_t_parent i = 0; i < count; i++)
+	{
+		if (letters[i] > next_letter)
+			zeros_groups++;
+		next_letter = (letter_t_parent) letters[i] + 1;
+	}
+	if (next_letter <= alphabet_t::last_letter())
+		zeros_groups++;
+
+	return zeros_groups;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void TrieNode<character_t, value_t, alphabet_t, options_t>::fill_zeros_map( const letter_t* letters, letter_t_parent count, letter_t* zeros_map )
+{
+	letter_t_parent current_zeros_map_position = 0;
+	letter_t_parent next_letter = 0;
+	for (letter_t_parent i = 0; i < count; i++)
+	{
+		if (letters[i] > next_letter)
+		{
+			zeros_map[current_zeros_map_position++] = next_letter;
+			zeros_map[current_zeros_map_position++] = letters[i] - 1;
+		}
+		next_letter = (letter_t_parent) letters[i] + 1;
+	}
+	if (next_letter <= alphabet_t::last_letter())
+	{
+		zeros_map[current_zeros_map_position++] = next_letter;
+		zeros_map[current_zeros_map_position++] = alphabet_t::last_letter();
+	}
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+TrieNode<character_t, value_t, alphabet_t, options_t>* TrieNode<character_t, value_t, alphabet_t, options_t>::get_node_if_possible(const letter_t letter )
+{
+	letter_t_parent children_count = 0;
+
+	// letter exists before the 1st zeros group (ones group), or there are no zeros groups at all
+	if ( (this->zeros_map_half_size == 0) || (letter < this->zeros_map[0]) )
 		return this->children[ letter ];
 
 	// update current children count
 	children_count += this->zeros_map[0];
 
-	for ( character_t i = 0; i < (this->zeros_map_half_size*2)-2; i += 2)
+	for ( letter_t i = 0; i < (this->zeros_map_half_size*2)-2; i += 2)
 	{
 		// letter exists in a zeros group
 		if ( (this->zeros_map[i] <= letter) && (letter <= this->zeros_map[i+1]) )
@@ -189,7 +747,7 @@ TrieNode<character_t>* TrieNode<character_t>::get_node_if_possible(const charact
 	}
 
 	// letter exists in the last zeros group
-	character_t i = (this->zeros_map_half_size*2) - 2;
+	letter_t i = (this->zeros_map_half_size*2) - 2;
 	if ( (this->zeros_map[i] <= letter) && (letter <= this->zeros_map[i+1]) )
 		return NULL;
 
@@ -202,21 +760,21 @@ TrieNode<character_t>* TrieNode<character_t>::get_node_if_possible(const charact
 	return NULL;
 }
 
-template <class character_t>
-TrieNode<character_t>* TrieNode<character_t>::insert_letter(const character_t letter )
+template <class character_t, class value_t, class alphabet_t, class options_t>
+TrieNode<character_t, value_t, alphabet_t, options_t>* TrieNode<character_t, value_t, alphabet_t, options_t>::insert_letter(const letter_t letter, TrieNode* child )
 {
 	/* 1) First
 			- count number of children pointers
 			- find the index of zeros_map that will be changed
 			- find the index at which the new pointer will be inserted in children array */
 
-	character_t_parent children_count = 0;
-	character_t index_to_insert_children, index_to_change_zeros;
+	letter_t_parent children_count = 0;
+	letter_t index_to_insert_children, index_to_change_zeros;
 
 	// update current children count
 	children_count += this->zeros_map[0];
 
-	for ( character_t i = 0; i < (this->zeros_map_half_size*2)-2; i += 2)
+	for ( letter_t i = 0; i < (this->zeros_map_half_size*2)-2; i += 2)
 	{
 		// found the zeros group that letter exists
 		if ( (this->zeros_map[i] <= letter) && (letter <= this->zeros_map[i+1]) )
@@ -237,28 +795,28 @@ TrieNode<character_t>* TrieNode<character_t>::insert_letter(const character_t le
 	}
 
 	// update current children count
-	children_count += std::numeric_limits<character_t>::max() - this->zeros_map[(this->zeros_map_half_size*2)-1];
+	children_count += alphabet_t::last_letter() - this->zeros_map[(this->zeros_map_half_size*2)-1];
 
 
 	/* 2) Now, create a new pointers array of size children_count+1,
 			with the extra addition of the pointer for the letter received as argument */
 
-	// Create the new TrieNode to return
-	TrieNode* toReturn = new TrieNode<character_t>();
+	// Create the new TrieNode to return, unless one is given
+	TrieNode* toReturn = (child != NULL) ? child : new TrieNode<character_t, value_t, alphabet_t, options_t>();
 
 	// Create new children pointers array
-	TrieNode **new_children = new TrieNode<character_t> *[children_count+1];
+	TrieNode **new_children = new TrieNode<character_t, value_t, alphabet_t, options_t> *[children_count+1];
 
-	for ( character_t i = 0; i < index_to_insert_children; i++)
+	for ( letter_t i = 0; i < index_to_insert_children; i++)
 		new_children[i] = this->children[i];
 
 	new_children[index_to_insert_children] = toReturn;
 
-	for ( character_t_parent i = index_to_insert_children+1; i < children_count+1; i++)
+	for ( letter_t_parent i = index_to_insert_children+1; i < children_count+1; i++)
 		new_children[i] = this->children[i-1];
 
 	// swap with current children pointers array and delete the old one
-	delete[] this->children;
+	this->release_children();
 	this->children = new_children;
 
 
@@ -270,21 +828,21 @@ TrieNode<character_t>* TrieNode<character_t>::insert_letter(const character_t le
 
 	if ( (this->zeros_map[index_to_change_zeros] < letter) && (letter < this->zeros_map[index_to_change_zeros+1]) )
 	{
-		character_t *new_zeros;
-		character_t old_end_value = this->zeros_map[index_to_change_zeros+1];
+		letter_t *new_zeros;
+		letter_t old_end_value = this->zeros_map[index_to_change_zeros+1];
 		this->zeros_map[index_to_change_zeros+1] = letter-1;
-		new_zeros = new character_t[(this->zeros_map_half_size*2)+2];
+		new_zeros = new letter_t[(this->zeros_map_half_size*2)+2];
 
-		for (character_t i = 0; i < index_to_change_zeros+2; i++)
+		for (letter_t i = 0; i < index_to_change_zeros+2; i++)
 			new_zeros[i] = this->zeros_map[i];
 
 		new_zeros[index_to_change_zeros+2] = letter+1;
 		new_zeros[index_to_change_zeros+3] = old_end_value;
 
-		for (character_t i = index_to_change_zeros+4; i < (this->zeros_map_half_size*2)+2; i++)
+		for (letter_t i = index_to_change_zeros+4; i < (this->zeros_map_half_size*2)+2; i++)
 			new_zeros[i] = this->zeros_map[i-2];
 
-		delete[] this->zeros_map;
+		this->release_zeros_map();
 		this->zeros_map = new_zeros;
 		this->zeros_map_half_size += 1;
 	}
@@ -298,16 +856,16 @@ TrieNode<character_t>* TrieNode<character_t>::insert_letter(const character_t le
 	}
 	else
 	{
-		character_t *new_zeros;
-		new_zeros = new character_t[(this->zeros_map_half_size*2)-2];
+		letter_t *new_zeros;
+		new_zeros = new letter_t[(this->zeros_map_half_size*2)-2];
 
-		for (character_t i = 0; i < index_to_change_zeros; i++)
+		for (letter_t i = 0; i < index_to_change_zeros; i++)
 			new_zeros[i] = this->zeros_map[i];
 
-		for (character_t_parent i = index_to_change_zeros+2; i < (this->zeros_map_half_size*2); i++)
+		for (letter_t_parent i = index_to_change_zeros+2; i < (this->zeros_map_half_size*2); i++)
 			new_zeros[i-2] = this->zeros_map[i];
 
-		delete[] this->zeros_map;
+		this->release_zeros_map();
 		this->zeros_map = new_zeros;
 		this->zeros_map_half_size -= 1;
 	}
@@ -316,16 +874,40 @@ TrieNode<character_t>* TrieNode<character_t>::insert_letter(const character_t le
 	return toReturn;
 }
 
-template <class character_t>
-bool TrieNode<character_t>::set_child_null(const character_t letter )
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool TrieNode<character_t, value_t, alphabet_t, options_t>::set_child_null(const letter_t letter )
 {
 	/* 1) First
 			- count number of children pointers
 			- find the index of zeros_map that will be changed
 			- find the index at which the pointer will be deleted from children array */
 
-	character_t_parent children_count = 0;
-	character_t index_to_delete_children, index_to_change_zeros;
+	// edge-case, no zeros groups (every letter has a child), letter becomes the only zeros group
+	if (this->zeros_map_half_size == 0)
+	{
+		letter_t_parent children_count = (letter_t_parent) alphabet_t::last_letter() + 1;
+		TrieNode **temp = new TrieNode<character_t, value_t, alphabet_t, options_t> *[children_count-1];
+
+		for ( letter_t_parent i = 0; i < letter; i++)
+			temp[i] = this->children[i];
+
+		for ( letter_t_parent i = (letter_t_parent) letter+1; i < children_count; i++)
+			temp[i-1] = this->children[i];
+
+		this->release_children();
+		this->children = temp;
+
+		this->release_zeros_map();
+		this->zeros_map = new letter_t[2];
+		this->zeros_map[0] = letter;
+		this->zeros_map[1] = letter;
+		this->zeros_map_half_size = 1;
+
+		return true;
+	}
+
+	letter_t_parent children_count = 0;
+	letter_t index_to_delete_children, index_to_change_zeros;
 
 	// letter exists before the 1st zeros group (ones group)
 	// in this case, we don't set index_to_change_zeros, because it can't have a value of -1 (see how we handle it in step 3)
@@ -337,7 +919,7 @@ bool TrieNode<character_t>::set_child_null(const character_t letter )
 	// update current children count
 	children_count += this->zeros_map[0];
 
-	for ( character_t i = 0; i < (this->zeros_map_half_size*2)-2; i += 2)
+	for ( letter_t i = 0; i < (this->zeros_map_half_size*2)-2; i += 2)
 	{
 		// found the zeros group after which the letter exists
 		if ( (this->zeros_map[i+1] < letter) && (letter < this->zeros_map[i+2]) )
@@ -358,7 +940,7 @@ bool TrieNode<character_t>::set_child_null(const character_t letter )
 	}
 
 	// update current children count
-	children_count += std::numeric_limits<character_t>::max() - this->zeros_map[(this->zeros_map_half_size*2)-1];
+	children_count += alphabet_t::last_letter() - this->zeros_map[(this->zeros_map_half_size*2)-1];
 
 
 	/* 2) Now, create a new pointers array of size children_count-1,
@@ -366,16 +948,16 @@ bool TrieNode<character_t>::set_child_null(const character_t letter )
 
 	// Create new child pointers array
 	TrieNode **temp;
-	(children_count > 1) ? temp = new TrieNode<character_t> *[children_count-1] : temp = NULL;
+	(children_count > 1) ? temp = new TrieNode<character_t, value_t, alphabet_t, options_t> *[children_count-1] : temp = NULL;
 
-	for ( character_t i = 0; i < index_to_delete_children; i++)
+	for ( letter_t i = 0; i < index_to_delete_children; i++)
 		temp[i] = this->children[i];
 
-	for ( character_t_parent i = index_to_delete_children+1; i < children_count; i++)
+	for ( letter_t_parent i = index_to_delete_children+1; i < children_count; i++)
 		temp[i-1] = this->children[i];
 
 	// swap with current child pointers array and delete the old one
-	delete[] this->children;
+	this->release_children();
 	this->children = temp;
 
 
@@ -403,16 +985,16 @@ bool TrieNode<character_t>::set_child_null(const character_t letter )
 		}
 		else
 		{
-			character_t *new_zeros;
-			new_zeros = new character_t[(this->zeros_map_half_size*2)+2];
+			letter_t *new_zeros;
+			new_zeros = new letter_t[(this->zeros_map_half_size*2)+2];
 
 			new_zeros[0] = letter;
 			new_zeros[1] = letter;
 
-			for (character_t i = 0; i < (this->zeros_map_half_size*2); i++)
+			for (letter_t i = 0; i < (this->zeros_map_half_size*2); i++)
 				new_zeros[i+2] = this->zeros_map[i];
 
-			delete[] this->zeros_map;
+			this->release_zeros_map();
 			this->zeros_map = new_zeros;
 			this->zeros_map_half_size += 1;
 		}
@@ -425,16 +1007,16 @@ bool TrieNode<character_t>::set_child_null(const character_t letter )
 		}
 		else
 		{
-			character_t *new_zeros;
-			new_zeros = new character_t[(this->zeros_map_half_size*2)+2];
+			letter_t *new_zeros;
+			new_zeros = new letter_t[(this->zeros_map_half_size*2)+2];
 
-			for (character_t i = 0; i < (this->zeros_map_half_size*2); i++)
+			for (letter_t i = 0; i < (this->zeros_map_half_size*2); i++)
 				new_zeros[i] = this->zeros_map[i];
 
 			new_zeros[index_to_change_zeros+1] = letter;
 			new_zeros[index_to_change_zeros+2] = letter;
 
-			delete[] this->zeros_map;
+			this->release_zeros_map();
 			this->zeros_map = new_zeros;
 			this->zeros_map_half_size += 1;
 		}
@@ -443,16 +1025,16 @@ bool TrieNode<character_t>::set_child_null(const character_t letter )
 	{
 		this->zeros_map[index_to_change_zeros] = this->zeros_map[index_to_change_zeros+2];
 
-		character_t *new_zeros;
-		new_zeros = new character_t[(this->zeros_map_half_size*2)-2];
+		letter_t *new_zeros;
+		new_zeros = new letter_t[(this->zeros_map_half_size*2)-2];
 
-		for (character_t i = 0; i < index_to_change_zeros+1; i++)
+		for (letter_t i = 0; i < index_to_change_zeros+1; i++)
 			new_zeros[i] = this->zeros_map[i];
 
-		for (character_t_parent i = index_to_change_zeros+3; i < (this->zeros_map_half_size*2); i++)
+		for (letter_t_parent i = index_to_change_zeros+3; i < (this->zeros_map_half_size*2); i++)
 			new_zeros[i-2] = this->zeros_map[i];
 
-		delete[] this->zeros_map;
+		this->release_zeros_map();
 		this->zeros_map = new_zeros;
 		this->zeros_map_half_size -= 1;
 	}
@@ -466,19 +1048,19 @@ bool TrieNode<character_t>::set_child_null(const character_t letter )
 	}
 	else
 	{
-		character_t *new_zeros;
-		new_zeros = new character_t[(this->zeros_map_half_size*2)+2];
+		letter_t *new_zeros;
+		new_zeros = new letter_t[(this->zeros_map_half_size*2)+2];
 
-		for (character_t i = 0; i < index_to_change_zeros+1; i++)
+		for (letter_t i = 0; i < index_to_change_zeros+1; i++)
 			new_zeros[i] = this->zeros_map[i];
 
 		new_zeros[index_to_change_zeros+1] = letter;
 		new_zeros[index_to_change_zeros+2] = letter;
 
-		for (character_t i = index_to_change_zeros+1; i < (this->zeros_map_half_size*2); i++)
+		for (letter_t i = index_to_change_zeros+1; i < (this->zeros_map_half_size*2); i++)
 			new_zeros[i+2] = this->zeros_map[i];
 
-		delete[] this->zeros_map;
+		this->release_zeros_map();
 		this->zeros_map = new_zeros;
 		this->zeros_map_half_size += 1;
 	}
@@ -486,47 +1068,75 @@ bool TrieNode<character_t>::set_child_null(const character_t letter )
 	return true;
 }
 
-template <class character_t>
-void TrieNode<character_t>::save_subtrie( std::vector<character_t> current_word, std::vector<character_t> letter_to_append, FILE* file)
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void TrieNode<character_t, value_t, alphabet_t, options_t>::save_pair( const std::vector<character_t>& current_word, FILE* file, character_t end_of_string, bool save_scores)
+{
+	if ( !translation_traits::exists(this->translation) )
+		return;
+
+	uint8_t word_size = current_word.size();
+	fwrite( &word_size, sizeof(uint8_t), 1, file);
+	fwrite( current_word.data(), sizeof(character_t), current_word.size(), file);
+
+	translation_traits::write( this->translation, file, end_of_string);
+
+	if (save_scores)
+	{
+		uint32_t score = this->get_score();
+		fwrite( &score, sizeof(uint32_t), 1, file);
+	}
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+uint64_t TrieNode<character_t, value_t, alphabet_t, options_t>::saved_size( uint32_t depth, character_t end_of_string, bool save_scores)
+{
+	uint64_t toReturn = 0;
+
+	if ( translation_traits::exists(this->translation) )
+		toReturn += sizeof(uint8_t) + (uint64_t) depth * sizeof(character_t) + translation_traits::file_size( this->translation, end_of_string) +
+					(save_scores ? sizeof(uint32_t) : 0);
+
+	this->for_each_child( 0, [&]( letter_t, TrieNode* child)
+	{
+		toReturn += child->saved_size( depth + 1, end_of_string, save_scores);
+		return false;
+	});
+
+	return toReturn;
+}
+
+template <class character_t, class value_t, class alphabet_t, class options_t>
+void TrieNode<character_t, value_t, alphabet_t, options_t>::save_subtrie( std::vector<character_t> current_word, std::vector<character_t> letter_to_append, FILE* file, character_t end_of_string, bool save_scores)
 {
 	// append letter of path to current word
 	current_word.insert(current_word.end(), letter_to_append.begin(), letter_to_append.end());
 
 	// write current translation in dictionary file, if there exists one
-	if ( this->translation != NULL)
-	{
-		uint8_t word_size = current_word.size();
-		fwrite( &word_size, sizeof(uint8_t), 1, file);
-		fwrite( current_word.data(), sizeof(character_t), current_word.size(), file);
-
-		uint16_t translation_size = strlen(this->translation);
-		fwrite( &translation_size, sizeof(uint16_t), 1, file);
-		fwrite( this->translation, sizeof(character_t), strlen(this->translation), file);
-	}
+	this->save_pair( current_word, file, end_of_string, save_scores);
 
 	// read zeros map
 	// for every active letter that you find, call recursive saving function
 	// we also need the value of the letter, so we can't just get the children_count (like in the destructor)
-	character_t next_child = 0;
-	character_t_parent current_letter = 0;
-	character_t_parent current_zeros_map_position = 0;
+	letter_t_parent next_child = 0;
+	letter_t_parent current_letter = 0;
+	letter_t_parent current_zeros_map_position = 0;
 	while(current_zeros_map_position != this->zeros_map_half_size*2)
 	{
 		while (zeros_map[current_zeros_map_position] != current_letter)
-			this->children[next_child++]->save_subtrie( current_word, std::vector<character_t>( 1, current_letter++), file);
+			this->children[next_child++]->save_subtrie( current_word, std::vector<character_t>( 1, alphabet_t::to_character( (letter_t) current_letter++)), file, end_of_string, save_scores);
 
 		current_letter = zeros_map[current_zeros_map_position+1] + 1;
 		current_zeros_map_position += 2;
 	}
 
 	// letters after last zeros_group (if there exist any)
-	character_t_parent alphabet_size =  std::numeric_limits<character_t>::max() + 1;
+	letter_t_parent alphabet_size =  (letter_t_parent) alphabet_t::last_letter() + 1;
 	while (current_letter != alphabet_size)
-		this->children[next_child++]->save_subtrie( current_word, std::vector<character_t>( 1, (character_t) current_letter++), file);
+		this->children[next_child++]->save_subtrie( current_word, std::vector<character_t>( 1, alphabet_t::to_character( (letter_t) current_letter++)), file, end_of_string, save_scores);
 }
 
-template <class character_t>
-bool TrieNode<character_t>::get_prefix_words( std::vector< std::vector<character_t> >& toReturn,
+template <class character_t, class value_t, class alphabet_t, class options_t>
+bool TrieNode<character_t, value_t, alphabet_t, options_t>::get_prefix_words( std::vector< std::vector<character_t> >& toReturn,
 												std::vector<character_t> current_word,
 												std::vector<character_t> letter_to_append,
 												int64_t& count)
@@ -535,7 +1145,7 @@ bool TrieNode<character_t>::get_prefix_words( std::vector< std::vector<character
 	current_word.insert(current_word.end(), letter_to_append.begin(), letter_to_append.end());
 
 	// write current word in return list, if there exists one
-	if ( this->translation != NULL)
+	if ( translation_traits::exists(this->translation) )
 	{
 		toReturn.push_back( current_word );
 
@@ -548,13 +1158,13 @@ bool TrieNode<character_t>::get_prefix_words( std::vector< std::vector<character
 	// read zeros map
 	// for every active letter that you find, call recursive get_prefix_words function, until count reaches 0
 	// we also need the value of the letter, so we can't just get the children_count (like in the destructor)
-	character_t next_child = 0;
-	character_t_parent current_letter = 0;
-	character_t_parent current_zeros_map_position = 0;
+	letter_t_parent next_child = 0;
+	letter_t_parent current_letter = 0;
+	letter_t_parent current_zeros_map_position = 0;
 	while(current_zeros_map_position != this->zeros_map_half_size*2)
 	{
 		while (zeros_map[current_zeros_map_position] != current_letter)
-			if( this->children[next_child++]->get_prefix_words( toReturn, current_word, std::vector<character_t>( 1, current_letter++), count) )
+			if( this->children[next_child++]->get_prefix_words( toReturn, current_word, std::vector<character_t>( 1, alphabet_t::to_character( (letter_t) current_letter++)), count) )
 				return true;
 
 		current_letter = zeros_map[current_zeros_map_position+1] + 1;
@@ -562,9 +1172,9 @@ bool TrieNode<character_t>::get_prefix_words( std::vector< std::vector<character
 	}
 
 	// letters after last zeros_group (if there exist any)
-	character_t_parent alphabet_size =  std::numeric_limits<character_t>::max() + 1;
+	letter_t_parent alphabet_size =  (letter_t_parent) alphabet_t::last_letter() + 1;
 	while (current_letter != alphabet_size)
-		if ( this->children[next_child++]->get_prefix_words( toReturn, current_word, std::vector<character_t>( 1, (character_t) current_letter++), count) )
+		if ( this->children[next_child++]->get_prefix_words( toReturn, current_word, std::vector<character_t>( 1, alphabet_t::to_character( (letter_t) current_letter++)), count) )
 			return true;
 
 	return false;
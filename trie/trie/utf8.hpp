@@ -0,0 +1,247 @@
+#ifndef TRIE_UTF8_H_
+#define TRIE_UTF8_H_
+
+#include <string>
+#include <vector>
+#include <string.h>
+#include <stdint.h>
+
+namespace trie
+{
+
+/* UTF-8 text to characters of a Trie and back
+	uint8_t  : bytes are kept as they are (UTF-8 code units)
+	uint16_t : UTF-16 code units, code points above 0xFFFF become surrogate pairs
+	uint32_t : code points (UTF-32)
+	ASCII parts of the text are checked 8 bytes at a time and widened without decoding */
+
+/* append the characters of the UTF-8 text [data, data+length) to output
+	return false if the text is not valid UTF-8 (overlong forms, surrogates, code points above 0x10FFFF, cut sequences)
+	output keeps its old size in that case */
+template <class character_t>
+bool utf8_decode( const char* data, size_t length, std::vector<character_t>& output);
+
+/* append the UTF-8 form of the characters [data, data+length) to output
+	unpaired UTF-16 surrogates and invalid code points are written as U+FFFD */
+template <class character_t>
+void utf8_encode( const character_t* data, size_t length, std::string& output);
+
+/* same, for the words given to and returned by a Trie (vectors that include the end_of_string) */
+template <class character_t>
+bool utf8_to_word( const std::string& text, std::vector<character_t>& word, character_t end_of_string = 0);
+template <class character_t>
+std::string word_to_utf8( const std::vector<character_t>& word, character_t end_of_string = 0);
+
+// return true if the 8 bytes starting at data are all ASCII
+inline bool utf8_is_ascii_block( const unsigned char* data)
+{
+	uint64_t block;
+	memcpy( &block, data, sizeof(uint64_t));
+	return (block & 0x8080808080808080ULL) == 0;
+}
+
+/* decode the code point starting at data[i] (not ASCII), move i after it
+	return false if the sequence is not valid */
+inline bool utf8_decode_code_point( const unsigned char* data, size_t length, size_t& i, uint32_t& code_point)
+{
+	unsigned char first = data[i];
+
+	// size of the sequence and smallest code point it can keep (smaller ones are overlong forms)
+	size_t size;
+	uint32_t minimum;
+	if ( (first & 0xE0) == 0xC0 )
+	{
+		size = 2;
+		minimum = 0x80;
+		code_point = first & 0x1F;
+	}
+	else if ( (first & 0xF0) == 0xE0 )
+	{
+		size = 3;
+		minimum = 0x800;
+		code_point = first & 0x0F;
+	}
+	else if ( (first & 0xF8) == 0xF0 )
+	{
+		size = 4;
+		minimum = 0x10000;
+		code_point = first & 0x07;
+	}
+	else
+	{
+		return false;
+	}
+
+	if (length - i < size)
+		return false;
+
+	for (size_t j = 1; j < size; j++)
+	{
+		if ( (data[i+j] & 0xC0) != 0x80 )
+			return false;
+		code_point = (code_point << 6) | (data[i+j] & 0x3F);
+	}
+
+	if ( (code_point < minimum) || (code_point > 0x10FFFF) || (code_point >= 0xD800 && code_point <= 0xDFFF) )
+		return false;
+
+	i += size;
+	return true;
+}
+
+template <class character_t>
+bool utf8_decode( const char* data, size_t length, std::vector<character_t>& output)
+{
+	static_assert( sizeof(character_t) == 1 || sizeof(character_t) == 2 || sizeof(character_t) == 4, "characters need 1, 2 or 4 bytes" );
+
+	const unsigned char* bytes = (const unsigned char*) data;
+	size_t old_size = output.size();
+
+	// every byte gives at most one character
+	output.resize( old_size + length );
+	character_t* write = output.data() + old_size;
+
+	size_t i = 0;
+	while (i < length)
+	{
+		// ASCII fast path
+		while ( (i + 8 <= length) && utf8_is_ascii_block( bytes + i ) )
+		{
+			for (size_t j = 0; j < 8; j++)
+				write[j] = bytes[i+j];
+			write += 8;
+			i += 8;
+		}
+
+		if (i == length)
+			break;
+
+		if (bytes[i] < 0x80)
+		{
+			*(write++) = bytes[i++];
+			continue;
+		}
+
+		size_t start = i;
+		uint32_t code_point;
+		if ( !utf8_decode_code_point( bytes, length, i, code_point) )
+		{
+			output.resize( old_size );
+			return false;
+		}
+
+		if (sizeof(character_t) == 1)
+		{
+			// keep the valid sequence as it is
+			for ( ; start != i; start++)
+				*(write++) = bytes[start];
+		}
+		else if (sizeof(character_t) == 2 && code_point > 0xFFFF)
+		{
+			code_point -= 0x10000;
+			*(write++) = (character_t) (0xD800 + (code_point >> 10));
+			*(write++) = (character_t) (0xDC00 + (code_point & 0x3FF));
+		}
+		else
+		{
+			*(write++) = (character_t) code_point;
+		}
+	}
+
+	output.resize( write - output.data() );
+	return true;
+}
+
+// append code point as UTF-8
+inline void utf8_append( uint32_t code_point, std::string& output)
+{
+	if ( (code_point > 0x10FFFF) || (code_point >= 0xD800 && code_point <= 0xDFFF) )
+		code_point = 0xFFFD;
+
+	if (code_point < 0x80)
+	{
+		output.push_back( (char) code_point );
+	}
+	else if (code_point < 0x800)
+	{
+		output.push_back( (char) (0xC0 | (code_point >> 6)) );
+		output.push_back( (char) (0x80 | (code_point & 0x3F)) );
+	}
+	else if (code_point < 0x10000)
+	{
+		output.push_back( (char) (0xE0 | (code_point >> 12)) );
+		output.push_back( (char) (0x80 | ((code_point >> 6) & 0x3F)) );
+		output.push_back( (char) (0x80 | (code_point & 0x3F)) );
+	}
+	else
+	{
+		output.push_back( (char) (0xF0 | (code_point >> 18)) );
+		output.push_back( (char) (0x80 | ((code_point >> 12) & 0x3F)) );
+		output.push_back( (char) (0x80 | ((code_point >> 6) & 0x3F)) );
+		output.push_back( (char) (0x80 | (code_point & 0x3F)) );
+	}
+}
+
+template <class character_t>
+void utf8_encode( const character_t* data, size_t length, std::string& output)
+{
+	static_assert( sizeof(character_t) == 1 || sizeof(character_t) == 2 || sizeof(character_t) == 4, "characters need 1, 2 or 4 bytes" );
+
+	// bytes are already UTF-8
+	if (sizeof(character_t) == 1)
+	{
+		output.append( (const char*) data, length );
+		return;
+	}
+
+	output.reserve( output.size() + length );
+
+	size_t i = 0;
+	while (i < length)
+	{
+		// ASCII characters are copied as they are
+		if (data[i] < 0x80)
+		{
+			output.push_back( (char) data[i++] );
+			continue;
+		}
+
+		uint32_t code_point = data[i++];
+
+		// UTF-16 surrogate pair
+		if ( sizeof(character_t) == 2 && (code_point >= 0xD800 && code_point <= 0xDBFF) &&
+			 (i < length) && (data[i] >= 0xDC00 && data[i] <= 0xDFFF) )
+			code_point = 0x10000 + ((code_point - 0xD800) << 10) + (data[i++] - 0xDC00);
+
+		utf8_append( code_point, output);
+	}
+}
+
+template <class character_t>
+bool utf8_to_word( const std::string& text, std::vector<character_t>& word, character_t end_of_string)
+{
+	word.clear();
+	if ( !utf8_decode( text.data(), text.size(), word) )
+		return false;
+
+	word.push_back( end_of_string );
+	return true;
+}
+
+template <class character_t>
+std::string word_to_utf8( const std::vector<character_t>& word, character_t end_of_string)
+{
+	std::string toReturn;
+
+	size_t length = 0;
+	while ( (length < word.size()) && (word[length] != end_of_string) )
+		length++;
+
+	utf8_encode( word.data(), length, toReturn);
+
+	return toReturn;
+}
+
+}
+
+#endif
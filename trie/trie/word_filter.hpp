@@ -0,0 +1,167 @@
+#ifndef TRIE_WORD_FILTER_H_
+#define TRIE_WORD_FILTER_H_
+
+#include <vector>
+#include <algorithm>
+#include <stdio.h>
+#include <stdint.h>
+
+namespace trie
+{
+
+/* 64-bit hash of a word, FNV-1a over its characters with a final mix of the bits (see WordFilter and WordIndex) */
+template <class character_t>
+uint64_t word_hash( const character_t* word, uint32_t word_length)
+{
+	uint64_t toReturn = 0xCBF29CE484222325ULL;
+	for (uint32_t i=0; i < word_length; i++)
+		toReturn = (toReturn ^ (uint64_t) word[i]) * 0x100000001B3ULL;
+
+	toReturn ^= toReturn >> 33;
+	toReturn *= 0xFF51AFD7ED558CCDULL;
+	toReturn ^= toReturn >> 33;
+	toReturn *= 0xC4CEB9FE1A85EC53ULL;
+	toReturn ^= toReturn >> 33;
+
+	return toReturn;
+}
+
+/* approximate set of words (a blocked Bloom filter, see Trie::enable_word_filter)
+	may_contain never returns false for an added word, and returns true for a word that was never added ~1% of the time
+	the bits are split in blocks of 64 bytes, a word sets (and a lookup reads) 8 bits of a single block, one in each of its uint64_t
+	words can't be removed, removed words are only counted (stale words), a new filter is built when there are too many of them */
+class WordFilter
+{
+private:
+	static const uint64_t BLOCK_WORDS = 8;		// uint64_t of a block
+	static const uint64_t BITS_PER_WORD = 12;	// bits of the filter for every word of the capacity
+
+	std::vector<uint64_t> blocks;
+	uint64_t block_mask;
+
+	/* words the filter was built for, words added and stale words since then */
+	uint64_t capacity;
+	uint64_t word_count;
+	uint64_t stale_count;
+
+	void set_capacity( uint64_t words);
+
+public:
+	/* empty filter for about capacity words */
+	WordFilter( uint64_t capacity);
+
+	template <class character_t>
+	void add( const character_t* word, uint32_t word_length);
+	template <class character_t>
+	bool may_contain( const character_t* word, uint32_t word_length);
+
+	/* count removed words */
+	void remove( uint64_t words);
+
+	/* return true if the filter is over its capacity, or if most of its words are stale */
+	bool needs_rebuild();
+
+	/* memory of the filter */
+	uint64_t get_bytes();
+
+	/* [number of blocks (8 bytes)][words (8 bytes)][stale words (8 bytes)][blocks]
+		read returns false for a broken filter, or a filter that needs more than the size bytes that are left for it in the file */
+	void write( FILE* file);
+	bool read( FILE* file, uint64_t size);
+};
+
+inline WordFilter::WordFilter( uint64_t capacity)
+{
+	this->set_capacity( capacity );
+}
+
+inline void WordFilter::set_capacity( uint64_t words)
+{
+	// a power of 2 of blocks, so that a block is picked with a mask
+	uint64_t block_count = 1;
+	while (block_count * BLOCK_WORDS * 64 < std::max( words, (uint64_t) 1) * BITS_PER_WORD)
+		block_count *= 2;
+
+	this->blocks.assign( block_count * BLOCK_WORDS, 0);
+	this->block_mask = block_count - 1;
+	this->capacity = block_count * BLOCK_WORDS * 64 / BITS_PER_WORD;
+	this->word_count = 0;
+	this->stale_count = 0;
+}
+
+template <class character_t>
+void WordFilter::add( const character_t* word, uint32_t word_length)
+{
+	// the block comes from the high half of the hash, 6 bits of a second mix of it pick the bit of every uint64_t of the block
+	uint64_t h = word_hash( word, word_length);
+	uint64_t* block = this->blocks.data() + ((h >> 32) & this->block_mask) * BLOCK_WORDS;
+	uint64_t bits = h * 0x9E3779B97F4A7C15ULL;
+	for (uint64_t i=0; i < BLOCK_WORDS; i++, bits <<= 6)
+		block[i] |= 1ULL << (bits >> 58);
+
+	this->word_count++;
+}
+
+template <class character_t>
+bool WordFilter::may_contain( const character_t* word, uint32_t word_length)
+{
+	uint64_t h = word_hash( word, word_length);
+	const uint64_t* block = this->blocks.data() + ((h >> 32) & this->block_mask) * BLOCK_WORDS;
+
+	// same bits as add, checked without branches
+	uint64_t bits = h * 0x9E3779B97F4A7C15ULL;
+	uint64_t missing = 0;
+	for (uint64_t i=0; i < BLOCK_WORDS; i++, bits <<= 6)
+		missing |= ~block[i] & (1ULL << (bits >> 58));
+
+	return missing == 0;
+}
+
+inline void WordFilter::remove( uint64_t words)
+{
+	this->stale_count += words;
+}
+
+inline bool WordFilter::needs_rebuild()
+{
+	return (this->word_count > this->capacity) || (2 * this->stale_count > this->word_count);
+}
+
+inline uint64_t WordFilter::get_bytes()
+{
+	return sizeof(WordFilter) + this->blocks.size() * sizeof(uint64_t);
+}
+
+inline void WordFilter::write( FILE* file)
+{
+	uint64_t block_count = this->block_mask + 1;
+	fwrite( &block_count, sizeof(uint64_t), 1, file);
+	fwrite( &this->word_count, sizeof(uint64_t), 1, file);
+	fwrite( &this->stale_count, sizeof(uint64_t), 1, file);
+	fwrite( this->blocks.data(), sizeof(uint64_t), this->blocks.size(), file);
+}
+
+inline bool WordFilter::read( FILE* file, uint64_t size)
+{
+	uint64_t block_count, word_count, stale_count;
+	if ( (size < 3 * sizeof(uint64_t)) || (fread( &block_count, sizeof(uint64_t), 1, file) != 1) ||
+		 (fread( &word_count, sizeof(uint64_t), 1, file) != 1) || (fread( &stale_count, sizeof(uint64_t), 1, file) != 1) )
+		return false;
+
+	// a power of 2 of blocks, that the rest of the file keeps (nothing is allocated for a broken count)
+	uint64_t block_bytes = BLOCK_WORDS * sizeof(uint64_t);
+	if ( (block_count == 0) || ((block_count & (block_count - 1)) != 0) || (block_count > (size - 3 * sizeof(uint64_t)) / block_bytes) )
+		return false;
+
+	this->set_capacity( block_count * BLOCK_WORDS * 64 / BITS_PER_WORD );
+	if (fread( this->blocks.data(), sizeof(uint64_t), this->blocks.size(), file) != this->blocks.size())
+		return false;
+
+	this->word_count = word_count;
+	this->stale_count = stale_count;
+	return true;
+}
+
+}
+
+#endif
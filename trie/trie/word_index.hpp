@@ -0,0 +1,212 @@
+#ifndef TRIE_WORD_INDEX_H_
+#define TRIE_WORD_INDEX_H_
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+#include "trie/word_filter.hpp"
+
+namespace trie
+{
+
+/* hash table of words to values (see Trie::enable_word_index), with open addressing and linear probing
+	slots keep the hash of the word, so a lookup compares words only for equal hashes, and the words themselves in a single
+	buffer of characters ([length][characters], length in a single character), never in memory of their own
+	the table has at least twice as many slots as words, deleted words leave no tombstones (later slots are shifted back)
+	values can't be value_t(), that value marks empty slots */
+template <class character_t, class value_t>
+class WordIndex
+{
+private:
+	struct slot
+	{
+		uint64_t hash;
+		uint64_t key;		// position of the word in keys
+		value_t value;
+	};
+
+	std::vector<slot> slots;
+	uint64_t slot_mask;
+	uint64_t word_count;
+
+	/* words of the slots, and characters of deleted words that are still in it */
+	std::vector<character_t> keys;
+	uint64_t garbage;
+
+	bool same_word( const slot& s, const character_t* word, uint32_t word_length);
+
+	/* slot of word, or the empty slot where it would go */
+	uint64_t position( uint64_t hash, const character_t* word, uint32_t word_length);
+
+	/* move all words in a table of slot_count slots (a power of 2) */
+	void resize( uint64_t slot_count);
+
+	/* copy the words of the slots in a new buffer of characters, without the deleted ones */
+	void pack_keys();
+
+public:
+	WordIndex();
+
+	/* return the value of word, value_t() if the word is not in the index */
+	value_t find( const character_t* word, uint32_t word_length);
+
+	/* set the value of word, adding the word if it is not in the index */
+	void insert( const character_t* word, uint32_t word_length, value_t value);
+
+	/* delete word, return false if it is not in the index */
+	bool erase( const character_t* word, uint32_t word_length);
+
+	uint64_t get_word_count();
+
+	/* memory of the index */
+	uint64_t get_bytes();
+};
+
+template <class character_t, class value_t>
+WordIndex<character_t, value_t>::WordIndex()
+{
+	this->slots.assign( 16, slot() );
+	this->slot_mask = 15;
+	this->word_count = 0;
+	this->garbage = 0;
+}
+
+template <class character_t, class value_t>
+bool WordIndex<character_t, value_t>::same_word( const slot& s, const character_t* word, uint32_t word_length)
+{
+	const character_t* key = this->keys.data() + s.key;
+	return ((uint32_t) key[0] == word_length) && std::equal( word, word + word_length, key + 1);
+}
+
+template <class character_t, class value_t>
+uint64_t WordIndex<character_t, value_t>::position( uint64_t hash, const character_t* word, uint32_t word_length)
+{
+	uint64_t toReturn = hash & this->slot_mask;
+	while ( (this->slots[toReturn].value != value_t()) &&
+			((this->slots[toReturn].hash != hash) || !this->same_word( this->slots[toReturn], word, word_length)) )
+		toReturn = (toReturn + 1) & this->slot_mask;
+
+	return toReturn;
+}
+
+template <class character_t, class value_t>
+void WordIndex<character_t, value_t>::resize( uint64_t slot_count)
+{
+	std::vector<slot> old_slots( slot_count, slot() );
+	old_slots.swap( this->slots );
+	this->slot_mask = slot_count - 1;
+
+	for (slot& s : old_slots)
+	{
+		if (s.value == value_t())
+			continue;
+
+		uint64_t i = s.hash & this->slot_mask;
+		while (this->slots[i].value != value_t())
+			i = (i + 1) & this->slot_mask;
+		this->slots[i] = s;
+	}
+}
+
+template <class character_t, class value_t>
+void WordIndex<character_t, value_t>::pack_keys()
+{
+	std::vector<character_t> new_keys;
+	new_keys.reserve( this->keys.size() - this->garbage );
+
+	for (slot& s : this->slots)
+	{
+		if (s.value == value_t())
+			continue;
+
+		const character_t* key = this->keys.data() + s.key;
+		s.key = new_keys.size();
+		new_keys.insert( new_keys.end(), key, key + 1 + (uint32_t) key[0]);
+	}
+
+	this->keys.swap( new_keys );
+	this->garbage = 0;
+}
+
+template <class character_t, class value_t>
+value_t WordIndex<character_t, value_t>::find( const character_t* word, uint32_t word_length)
+{
+	return this->slots[ this->position( word_hash( word, word_length), word, word_length) ].value;
+}
+
+template <class character_t, class value_t>
+void WordIndex<character_t, value_t>::insert( const character_t* word, uint32_t word_length, value_t value)
+{
+	uint64_t hash = word_hash( word, word_length);
+	uint64_t i = this->position( hash, word, word_length);
+	if (this->slots[i].value != value_t())
+	{
+		this->slots[i].value = value;
+		return;
+	}
+
+	// at most half of the slots are used
+	if (2 * (this->word_count + 1) > this->slots.size())
+	{
+		this->resize( 2 * this->slots.size() );
+		i = this->position( hash, word, word_length);
+	}
+
+	this->slots[i].hash = hash;
+	this->slots[i].key = this->keys.size();
+	this->slots[i].value = value;
+	this->keys.push_back( (character_t) word_length );
+	this->keys.insert( this->keys.end(), word, word + word_length);
+	this->word_count++;
+}
+
+template <class character_t, class value_t>
+bool WordIndex<character_t, value_t>::erase( const character_t* word, uint32_t word_length)
+{
+	uint64_t i = this->position( word_hash( word, word_length), word, word_length);
+	if (this->slots[i].value == value_t())
+		return false;
+
+	this->garbage += 1 + word_length;
+	this->word_count--;
+
+	// shift back the following slots of the run that can't be found anymore after an empty slot at i
+	uint64_t j = i;
+	while (true)
+	{
+		j = (j + 1) & this->slot_mask;
+		if (this->slots[j].value == value_t())
+			break;
+
+		// home slot of the word at j, it can move to i only if i is not between its home and j
+		uint64_t home = this->slots[j].hash & this->slot_mask;
+		if ( (i <= j) ? ((home <= i) || (home > j)) : ((home <= i) && (home > j)) )
+		{
+			this->slots[i] = this->slots[j];
+			i = j;
+		}
+	}
+	this->slots[i] = slot();
+
+	if (2 * this->garbage > this->keys.size())
+		this->pack_keys();
+
+	return true;
+}
+
+template <class character_t, class value_t>
+uint64_t WordIndex<character_t, value_t>::get_word_count()
+{
+	return this->word_count;
+}
+
+template <class character_t, class value_t>
+uint64_t WordIndex<character_t, value_t>::get_bytes()
+{
+	return sizeof(WordIndex) + this->slots.capacity() * sizeof(slot) + this->keys.capacity() * sizeof(character_t);
+}
+
+}
+
+#endif